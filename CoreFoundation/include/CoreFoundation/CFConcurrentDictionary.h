@@ -0,0 +1,210 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      CFConcurrentDictionary.h
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ * @discussion  CFConcurrentDictionary manages dictionaries that can be
+ *              shared between threads without external locking.
+ *              Entries are distributed over a fixed number of stripes, by
+ *              key hash, and each stripe is guarded by its own lock, so
+ *              threads only contend when they access keys of the same
+ *              stripe.
+ *              Keys and values are retained and released using the
+ *              CFDictionaryKeyCallBacks and CFDictionaryValueCallBacks
+ *              provided at creation time, as with CFMutableDictionary.
+ *              As another thread may remove an entry at any time, values are
+ *              never returned unretained: functions returning a value follow
+ *              the Create Rule, and the value must be released using the
+ *              value release callback (CFRelease, with
+ *              kCFTypeDictionaryValueCallBacks).
+ */
+
+#ifndef CORE_FOUNDATION_CF_CONCURRENT_DICTIONARY_H
+#define CORE_FOUNDATION_CF_CONCURRENT_DICTIONARY_H
+
+#include <CoreFoundation/CFBase.h>
+#include <CoreFoundation/CFType.h>
+#include <CoreFoundation/CFDictionary.h>
+
+CF_EXTERN_C_BEGIN
+
+/*!
+ * @typedef     CFConcurrentDictionaryRef
+ * @abstract    A reference to a concurrent dictionary object.
+ */
+typedef struct CFConcurrentDictionary * CFConcurrentDictionaryRef;
+
+/*!
+ * @function    CFConcurrentDictionaryGetTypeID
+ * @abstract    Returns the type identifier for the CFConcurrentDictionary
+ *              opaque type.
+ * @result      The type identifier for the CFConcurrentDictionary opaque type.
+ */
+CF_EXPORT CFTypeID CFConcurrentDictionaryGetTypeID( void );
+
+/*!
+ * @function    CFConcurrentDictionaryCreate
+ * @abstract    Creates a new concurrent dictionary.
+ * @param       allocator       The allocator to use to allocate memory for the
+ *                              new dictionary and its storage for key-value
+ *                              pairs. Pass NULL or kCFAllocatorDefault to use
+ *                              the current default allocator.
+ * @param       capacity        A hint for the number of key-value pairs the
+ *                              dictionary will contain. Pass 0 for no hint.
+ * @param       keyCallBacks    The key callbacks, as for
+ *                              CFDictionaryCreateMutable.
+ * @param       valueCallBacks  The value callbacks, as for
+ *                              CFDictionaryCreateMutable.
+ * @result      A new concurrent dictionary, or NULL if there was a problem
+ *              creating the object. Ownership follows the Create Rule.
+ * @discussion  The callbacks may be called from any thread using the
+ *              dictionary, and some of them while a stripe is locked, so they
+ *              shall not access the dictionary.
+ */
+CF_EXPORT CFConcurrentDictionaryRef CFConcurrentDictionaryCreate( CFAllocatorRef allocator, CFIndex capacity, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks );
+
+/*!
+ * @function    CFConcurrentDictionaryCreateSnapshot
+ * @abstract    Creates an immutable dictionary with the entries of a
+ *              concurrent dictionary.
+ * @param       allocator   The allocator to use to allocate memory for the
+ *                          new dictionary. Pass NULL or kCFAllocatorDefault to
+ *                          use the current default allocator.
+ * @param       theDict     The concurrent dictionary to copy.
+ * @result      A new dictionary, with the callbacks of theDict, or NULL if
+ *              there was a problem creating the object. Ownership follows
+ *              the Create Rule.
+ * @discussion  Stripes are copied one after the other, so the snapshot is
+ *              consistent per stripe only, when other threads modify theDict
+ *              during the copy.
+ */
+CF_EXPORT CFDictionaryRef CFConcurrentDictionaryCreateSnapshot( CFAllocatorRef allocator, CFConcurrentDictionaryRef theDict );
+
+/*!
+ * @function    CFConcurrentDictionaryGetCount
+ * @abstract    Returns the number of key-value pairs in a concurrent
+ *              dictionary.
+ * @param       theDict     The dictionary to examine.
+ * @result      The number of key-value pairs in theDict. With concurrent
+ *              modifications, it may already be outdated when returned.
+ */
+CF_EXPORT CFIndex CFConcurrentDictionaryGetCount( CFConcurrentDictionaryRef theDict );
+
+/*!
+ * @function    CFConcurrentDictionaryContainsKey
+ * @abstract    Returns a Boolean value that indicates whether a given key is
+ *              in a concurrent dictionary.
+ * @param       theDict     The dictionary to search.
+ * @param       key         The key for which to find matches in theDict.
+ * @result      true if key is in theDict, otherwise false.
+ */
+CF_EXPORT Boolean CFConcurrentDictionaryContainsKey( CFConcurrentDictionaryRef theDict, const void * key );
+
+/*!
+ * @function    CFConcurrentDictionaryCopyValue
+ * @abstract    Returns the value associated with a given key.
+ * @param       theDict     The dictionary to examine.
+ * @param       key         The key for which to find a match in theDict.
+ * @result      The value associated with key in theDict, or NULL if no
+ *              key-value pair matching key exists. The value is retained
+ *              using the value retain callback, so ownership follows the
+ *              Create Rule.
+ */
+CF_EXPORT const void * CFConcurrentDictionaryCopyValue( CFConcurrentDictionaryRef theDict, const void * key );
+
+/*!
+ * @function    CFConcurrentDictionaryCopyOrAddValue
+ * @abstract    Atomically returns the value associated with a given key, or
+ *              adds a value for that key if there is none.
+ * @param       theDict     The dictionary to modify.
+ * @param       key         The key for which to find a match in theDict.
+ * @param       value       The value to add if key is not in theDict.
+ * @result      The value already associated with key, or value if it was
+ *              added. The result is retained using the value retain
+ *              callback, so ownership follows the Create Rule.
+ * @discussion  When several threads call this function with the same key,
+ *              only one value is added, and all threads get that value.
+ */
+CF_EXPORT const void * CFConcurrentDictionaryCopyOrAddValue( CFConcurrentDictionaryRef theDict, const void * key, const void * value );
+
+/*!
+ * @function    CFConcurrentDictionaryAddValue
+ * @abstract    Adds a key-value pair to a concurrent dictionary if the key
+ *              does not already exist.
+ * @param       theDict     The dictionary to modify.
+ * @param       key         The key of the value to add to theDict.
+ * @param       value       The value to add to theDict.
+ * @result      true if the key-value pair was added, false if key was already
+ *              in theDict.
+ */
+CF_EXPORT Boolean CFConcurrentDictionaryAddValue( CFConcurrentDictionaryRef theDict, const void * key, const void * value );
+
+/*!
+ * @function    CFConcurrentDictionarySetValue
+ * @abstract    Sets the value corresponding to a given key ("add if absent,
+ *              replace if present").
+ * @param       theDict     The dictionary to modify.
+ * @param       key         The key of the value to set in theDict.
+ * @param       value       The value to add to or replace in theDict.
+ */
+CF_EXPORT void CFConcurrentDictionarySetValue( CFConcurrentDictionaryRef theDict, const void * key, const void * value );
+
+/*!
+ * @function    CFConcurrentDictionaryReplaceValueIfEqual
+ * @abstract    Atomically replaces the value corresponding to a given key, if
+ *              it is equal to an expected value.
+ * @param       theDict     The dictionary to modify.
+ * @param       key         The key of the value to replace in theDict.
+ * @param       expected    The value key is expected to be associated with.
+ *                          Values are compared using the value equal
+ *                          callback, or pointer equality if it is NULL.
+ * @param       value       The new value for key.
+ * @result      true if the value was replaced, false if key is not in theDict
+ *              or its value is not equal to expected.
+ */
+CF_EXPORT Boolean CFConcurrentDictionaryReplaceValueIfEqual( CFConcurrentDictionaryRef theDict, const void * key, const void * expected, const void * value );
+
+/*!
+ * @function    CFConcurrentDictionaryRemoveValue
+ * @abstract    Removes a key-value pair.
+ * @param       theDict     The dictionary to modify.
+ * @param       key         The key of the key-value pair to remove.
+ * @result      true if the key-value pair was removed, false if key was not
+ *              in theDict.
+ */
+CF_EXPORT Boolean CFConcurrentDictionaryRemoveValue( CFConcurrentDictionaryRef theDict, const void * key );
+
+/*!
+ * @function    CFConcurrentDictionaryRemoveAllValues
+ * @abstract    Removes all the key-value pairs from a concurrent dictionary.
+ * @param       theDict     The dictionary to modify.
+ * @discussion  Stripes are emptied one after the other, so entries added to
+ *              a stripe that was already emptied are kept.
+ */
+CF_EXPORT void CFConcurrentDictionaryRemoveAllValues( CFConcurrentDictionaryRef theDict );
+
+CF_EXTERN_C_END
+
+#endif /* CORE_FOUNDATION_CF_CONCURRENT_DICTIONARY_H */
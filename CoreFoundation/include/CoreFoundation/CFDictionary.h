@@ -296,6 +296,33 @@ CF_EXPORT const CFDictionaryKeyCallBacks kCFCopyStringDictionaryKeyCallBacks;
  */
 CF_EXPORT const CFDictionaryKeyCallBacks kCFTypeDictionaryKeyCallBacks;
 
+/*!
+ * @constant    kCFCopyStringSeededDictionaryKeyCallBacks
+ * @abstract    Same as kCFCopyStringDictionaryKeyCallBacks, with a hash
+ *              callback resistant to hash flooding.
+ * @discussion  Keys are hashed with SipHash-1-3, using a random seed created
+ *              once per process. Use it when keys come from an untrusted
+ *              source (network input, parsed documents): choosing keys that
+ *              all collide under CFHash would otherwise make each insertion
+ *              and lookup linear in the size of the dictionary.
+ *              Hash values differ between processes, so they must not be
+ *              persisted. Hashing is slower than with CFHash, mostly for
+ *              long keys.
+ */
+CF_EXPORT const CFDictionaryKeyCallBacks kCFCopyStringSeededDictionaryKeyCallBacks;
+
+/*!
+ * @constant    kCFTypeSeededDictionaryKeyCallBacks
+ * @abstract    Same as kCFTypeDictionaryKeyCallBacks, with a hash callback
+ *              resistant to hash flooding.
+ * @discussion  CFString and CFData keys are hashed from their bytes with
+ *              SipHash-1-3, using a random seed created once per process.
+ *              Other keys are hashed with CFHash, and the result is
+ *              randomized the same way: this changes their placement, but
+ *              keys with equal CFHash values still collide.
+ */
+CF_EXPORT const CFDictionaryKeyCallBacks kCFTypeSeededDictionaryKeyCallBacks;
+
 /*!
  * @constant    kCFCopyStringDictionaryKeyCallBacks
  * @abstract    Predefined CFDictionaryValueCallBacks structure containing a set
@@ -412,6 +439,42 @@ CF_EXPORT CFDictionaryRef CFDictionaryCreate( CFAllocatorRef allocator, const vo
  */
 CF_EXPORT CFDictionaryRef CFDictionaryCreateCopy( CFAllocatorRef allocator, CFDictionaryRef theDict );
 
+/*!
+ * @function    CFDictionaryCreateFrozen
+ * @abstract    Creates an immutable dictionary with a read-only layout, for
+ *              tables that are built once and read many times.
+ * @param       allocator       As for CFDictionaryCreate.
+ * @param       keys            As for CFDictionaryCreate.
+ * @param       values          As for CFDictionaryCreate.
+ * @param       numValues       As for CFDictionaryCreate.
+ * @param       keyCallBacks    As for CFDictionaryCreate.
+ * @param       valueCallBacks  As for CFDictionaryCreate.
+ * @result      A new dictionary, or NULL if there was a problem creating the
+ *              object. Ownership follows the Create Rule.
+ * @discussion  Dictionaries with more than 8 entries are stored as a minimal
+ *              perfect hash: a lookup computes a single slot and compares a
+ *              single key, with no probing. Building that layout is several
+ *              times slower than CFDictionaryCreate, so it only pays off for
+ *              dictionaries that are looked up far more often than they are
+ *              created. Keys whose hash codes are identical can't be
+ *              separated, and get the regular layout of CFDictionaryCreate.
+ */
+CF_EXPORT CFDictionaryRef CFDictionaryCreateFrozen( CFAllocatorRef allocator, const void ** keys, const void ** values, CFIndex numValues, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks );
+
+/*!
+ * @function    CFDictionaryCreateFrozenCopy
+ * @abstract    Creates an immutable dictionary with the key-value pairs of
+ *              another dictionary, in the layout of CFDictionaryCreateFrozen.
+ * @param       allocator   As for CFDictionaryCreateCopy.
+ * @param       theDict     As for CFDictionaryCreateCopy.
+ * @result      A new dictionary that contains the same key-value pairs as
+ *              theDict, or NULL if there was a problem creating the object.
+ *              Ownership follows the Create Rule.
+ * @discussion  This is meant to freeze a table once it has been filled, for
+ *              instance with a mutable dictionary.
+ */
+CF_EXPORT CFDictionaryRef CFDictionaryCreateFrozenCopy( CFAllocatorRef allocator, CFDictionaryRef theDict );
+
 /*!
  * @function    CFDictionaryContainsKey
  * @abstract    Returns a Boolean value that indicates whether a given key is in
@@ -563,6 +626,84 @@ CF_EXPORT const void * CFDictionaryGetValue( CFDictionaryRef theDict, const void
  */
 CF_EXPORT Boolean CFDictionaryGetValueIfPresent( CFDictionaryRef theDict, const void * key, const void ** value );
 
+/*!
+ * @function    CFDictionaryGetValueForIntegerKey
+ * @abstract    Returns the value associated with an integer key.
+ * @param       theDict     The dictionary to examine. Its key callbacks must
+ *                          all be NULL, as for dictionaries created with
+ *                          CFDictionaryCreateMutableWithIntegerKeys.
+ * @param       key         The integer key.
+ * @result      The value associated with key, or NULL if there is none. If
+ *              the value is a Core Foundation object, ownership follows the
+ *              Get Rule.
+ * @discussion  On hosts with 64-bit pointers, this is equivalent to
+ *              CFDictionaryGetValue with key cast to a pointer. On hosts with
+ *              32-bit pointers, 64-bit keys are only supported by the integer
+ *              key functions.
+ */
+CF_EXPORT const void * CFDictionaryGetValueForIntegerKey( CFDictionaryRef theDict, SInt64 key );
+
+/*!
+ * @function    CFDictionaryGetValueForIntegerKeyIfPresent
+ * @abstract    Returns a Boolean value that indicates whether an integer key
+ *              is in a dictionary, and returns its value indirectly if it
+ *              exists.
+ * @param       theDict     The dictionary to examine. Its key callbacks must
+ *                          all be NULL.
+ * @param       key         The integer key.
+ * @param       value       A pointer to memory which, on return, is filled
+ *                          with the value if key is found. This value may be
+ *                          NULL.
+ * @result      true if key was found, otherwise false.
+ */
+CF_EXPORT Boolean CFDictionaryGetValueForIntegerKeyIfPresent( CFDictionaryRef theDict, SInt64 key, const void ** value );
+
+/*!
+ * @function    CFDictionaryContainsIntegerKey
+ * @abstract    Returns a Boolean value that indicates whether an integer key
+ *              is in a dictionary.
+ * @param       theDict     The dictionary to examine. Its key callbacks must
+ *                          all be NULL.
+ * @param       key         The integer key.
+ * @result      true if key is in theDict, otherwise false.
+ */
+CF_EXPORT Boolean CFDictionaryContainsIntegerKey( CFDictionaryRef theDict, SInt64 key );
+
+/*!
+ * @function    CFDictionaryGetValueForCString
+ * @abstract    Returns the value associated with a string key, given as C
+ *              string bytes.
+ * @param       theDict     The dictionary to examine.
+ * @param       cStr        The bytes of the key, in the encoding of the
+ *                          CFString keys of theDict.
+ * @param       length      The number of bytes in cStr, or a negative value
+ *                          if cStr is NUL terminated.
+ * @result      The value associated with the CFString key equal to cStr, or
+ *              NULL if there is none. If the value is a Core Foundation
+ *              object, ownership follows the Get Rule.
+ * @discussion  This is equivalent to creating a CFString from cStr and
+ *              calling CFDictionaryGetValue, without creating the string.
+ *              cStr needs not be NUL terminated when length is given.
+ *              The key callbacks of theDict are called with a CFString, so
+ *              they must handle CFString keys, as with
+ *              kCFTypeDictionaryKeyCallBacks.
+ */
+CF_EXPORT const void * CFDictionaryGetValueForCString( CFDictionaryRef theDict, const char * cStr, CFIndex length );
+
+/*!
+ * @function    CFDictionaryContainsCStringKey
+ * @abstract    Returns a Boolean value that indicates whether a string key,
+ *              given as C string bytes, is in a dictionary.
+ * @param       theDict     The dictionary to examine.
+ * @param       cStr        The bytes of the key, as for
+ *                          CFDictionaryGetValueForCString.
+ * @param       length      The number of bytes in cStr, or a negative value
+ *                          if cStr is NUL terminated.
+ * @result      true if a CFString key equal to cStr is in theDict, otherwise
+ *              false.
+ */
+CF_EXPORT Boolean CFDictionaryContainsCStringKey( CFDictionaryRef theDict, const char * cStr, CFIndex length );
+
 /*!
  * @function    CFDictionaryApplyFunction
  * @abstract    Calls a function once for each key-value pair in a dictionary.
@@ -584,6 +725,119 @@ CF_EXPORT Boolean CFDictionaryGetValueIfPresent( CFDictionaryRef theDict, const
  */
 CF_EXPORT void CFDictionaryApplyFunction( CFDictionaryRef theDict, CFDictionaryApplierFunction applier, void * context );
 
+/*!
+ * @constant    kCFDictionaryDiagnosticsCountKey
+ * @abstract    Number of key-value pairs (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsCountKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsCapacityKey
+ * @abstract    Number of buckets in the storage of the dictionary (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsCapacityKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsLoadFactorKey
+ * @abstract    Ratio of the count to the capacity (CFNumber, double).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsLoadFactorKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsDeletedCountKey
+ * @abstract    Number of buckets left deleted by removals, which lookups
+ *              still probe until the next resize (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsDeletedCountKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsLayoutKey
+ * @abstract    Storage layout of the dictionary: "Inline", "Table" or
+ *              "Frozen" (CFString).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsLayoutKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsProbeLengthHistogramKey
+ * @abstract    Number of keys for each probe length (CFDictionary, with
+ *              CFNumber keys and values).
+ * @discussion  The probe length of a key is the number of groups of buckets
+ *              examined to find it. A key stored in the group its hash maps
+ *              to has a probe length of 1. Probe lengths above 16 are counted
+ *              with 16.
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsProbeLengthHistogramKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsAverageProbeLengthKey
+ * @abstract    Average probe length of the keys (CFNumber, double).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsAverageProbeLengthKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsMaxProbeLengthKey
+ * @abstract    Longest probe length of the keys (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsMaxProbeLengthKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsResizeCountKey
+ * @abstract    Number of times the storage was resized since the dictionary
+ *              was created (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsResizeCountKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsHashCallbackCountKey
+ * @abstract    Number of calls to the key hash callback while dictionary
+ *              profiling was enabled (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsHashCallbackCountKey;
+
+/*!
+ * @constant    kCFDictionaryDiagnosticsEqualCallbackCountKey
+ * @abstract    Number of calls to the key equal callback while dictionary
+ *              profiling was enabled (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFDictionaryDiagnosticsEqualCallbackCountKey;
+
+/*!
+ * @function    CFDictionaryCopyDiagnostics
+ * @abstract    Returns statistics about the hash table of a dictionary.
+ * @param       theDict     The dictionary to examine.
+ * @result      A dictionary containing the kCFDictionaryDiagnostics keys, or
+ *              NULL if theDict is NULL. Ownership follows the Create Rule.
+ * @discussion  Probe lengths are computed from the current storage, so this
+ *              takes time proportional to its capacity. Long probes with a
+ *              low load factor usually mean that the hash callback maps many
+ *              keys to the same values.
+ */
+CF_EXPORT CFDictionaryRef CFDictionaryCopyDiagnostics( CFDictionaryRef theDict );
+
+/*!
+ * @function    CFDictionarySetProfilingEnabled
+ * @abstract    Enables or disables counting of key callback calls, for all
+ *              dictionaries.
+ * @param       enabled     Whether dictionary profiling is enabled.
+ * @discussion  Profiling is disabled by default. While disabled, lookups
+ *              only pay for a single extra load.
+ */
+CF_EXPORT void CFDictionarySetProfilingEnabled( Boolean enabled );
+
+/*!
+ * @function    CFDictionarySetProbeLengthWarningThreshold
+ * @abstract    Reports dictionaries whose keys are poorly distributed.
+ * @param       threshold   The average probe length above which a
+ *                          dictionary is reported, or 0 to disable reports.
+ * @discussion  When enabled, each time a dictionary table is rehashed, the
+ *              average probe length of the new table is computed, and a
+ *              warning is written to stderr if it exceeds threshold. A
+ *              freshly rehashed table has no deleted buckets, so long probes
+ *              then come from the hash callback. Reports are disabled by
+ *              default. A threshold around 2 is a reasonable start.
+ */
+CF_EXPORT void CFDictionarySetProbeLengthWarningThreshold( double threshold );
+
 CF_EXTERN_C_END
 
 #endif /* CORE_FOUNDATION_CF_DICTIONARY_H */
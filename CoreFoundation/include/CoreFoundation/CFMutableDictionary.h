@@ -127,6 +127,30 @@ typedef struct CFDictionary * CFMutableDictionaryRef;
  */
 CF_EXPORT CFMutableDictionaryRef CFDictionaryCreateMutable( CFAllocatorRef allocator, CFIndex capacity, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks );
 
+/*!
+ * @function    CFDictionaryCreateMutableWithIntegerKeys
+ * @abstract    Creates a new mutable dictionary, with 64-bit integers as keys.
+ * @param       allocator       The allocator to use to allocate memory for the
+ *                              new dictionary and its storage for key-value
+ *                              pairs.
+ * @param       capacity        The maximum number of key-value pairs that can
+ *                              be contained by the new dictionary, or 0.
+ * @param       valueCallBacks  The value callbacks, as for
+ *                              CFDictionaryCreateMutable.
+ * @result      A new dictionary, or NULL if there was a problem creating the
+ *              object. Ownership follows the Create Rule.
+ * @discussion  Keys are stored as is, without callbacks, and hashed with an
+ *              integer mix, so lookups never call a function for keys. Use
+ *              the integer key functions (CFDictionarySetValueForIntegerKey,
+ *              CFDictionaryGetValueForIntegerKey, ...) rather than boxing
+ *              keys in CFNumber objects.
+ *              This is the same as calling CFDictionaryCreateMutable with NULL
+ *              key callbacks, so the integer key functions also accept such
+ *              dictionaries. Enumerated keys are the integers cast to
+ *              pointers, which truncates them on hosts with 32-bit pointers.
+ */
+CF_EXPORT CFMutableDictionaryRef CFDictionaryCreateMutableWithIntegerKeys( CFAllocatorRef allocator, CFIndex capacity, const CFDictionaryValueCallBacks * valueCallBacks );
+
 /*!
  * @function    CFDictionaryCreateMutableCopy
  * @abstract    Creates a new mutable dictionary with the key-value pairs from
@@ -179,11 +203,29 @@ CF_EXPORT CFMutableDictionaryRef CFDictionaryCreateMutableCopy( CFAllocatorRef a
  */
 CF_EXPORT void CFDictionaryAddValue( CFMutableDictionaryRef theDict, const void * key, const void * value );
 
+/*!
+ * @function    CFDictionaryAddValues
+ * @abstract    Adds key-value pairs to a dictionary, for the keys that are
+ *              not already present.
+ * @param       theDict     The dictionary to modify.
+ * @param       keys        A C array of count keys, retained as with
+ *                          CFDictionaryAddValue.
+ * @param       values      A C array of count values, retained as with
+ *                          CFDictionaryAddValue.
+ * @param       count       The number of key-value pairs to add.
+ * @discussion  This is equivalent to calling CFDictionaryAddValue for each
+ *              pair, in order, but the storage of theDict grows at most once,
+ *              and each key is hashed once, and looked up with the same probe
+ *              that finds its insertion slot.
+ */
+CF_EXPORT void CFDictionaryAddValues( CFMutableDictionaryRef theDict, const void ** keys, const void ** values, CFIndex count );
+
 /*!
  * @function    CFDictionaryRemoveAllValues
  * @abstract    Removes all the key-value pairs from a dictionary, making it
  *              empty.
  * @param       theDict     The dictionary to modify.
+ * @discussion  The storage of theDict is released as well.
  */
 CF_EXPORT void CFDictionaryRemoveAllValues( CFMutableDictionaryRef theDict );
 
@@ -196,9 +238,20 @@ CF_EXPORT void CFDictionaryRemoveAllValues( CFMutableDictionaryRef theDict );
  *                          the key-value pair is removed from the dictionary,
  *                          otherwise this function does nothing
  *                          ("remove if present").
+ * @discussion  The storage of theDict shrinks once most of its key-value
+ *              pairs have been removed.
  */
 CF_EXPORT void CFDictionaryRemoveValue( CFMutableDictionaryRef theDict, const void * key );
 
+/*!
+ * @function    CFDictionaryRemoveValueForIntegerKey
+ * @abstract    Removes the key-value pair for an integer key.
+ * @param       theDict     The dictionary to modify. Its key callbacks must
+ *                          all be NULL.
+ * @param       key         The integer key of the pair to remove.
+ */
+CF_EXPORT void CFDictionaryRemoveValueForIntegerKey( CFMutableDictionaryRef theDict, SInt64 key );
+
 /*!
  * @function    CFDictionaryReplaceValue
  * @abstract    Replaces a value corresponding to a given key.
@@ -240,6 +293,78 @@ CF_EXPORT void CFDictionaryReplaceValue( CFMutableDictionaryRef theDict, const v
  */
 CF_EXPORT void CFDictionarySetValue( CFMutableDictionaryRef theDict, const void * key, const void * value );
 
+/*!
+ * @function    CFDictionarySetValueForIntegerKey
+ * @abstract    Sets the value corresponding to an integer key.
+ * @param       theDict     The dictionary to modify. Its key callbacks must
+ *                          all be NULL.
+ * @param       key         The integer key ("add if absent, replace if
+ *                          present").
+ * @param       value       The value to add to or replace in theDict. value is
+ *                          retained using the value retain callback.
+ */
+CF_EXPORT void CFDictionarySetValueForIntegerKey( CFMutableDictionaryRef theDict, SInt64 key, const void * value );
+
+/*!
+ * @function    CFDictionarySetIncrementalResizeEnabled
+ * @abstract    Enables or disables incremental resizing for a dictionary.
+ * @param       theDict     The dictionary to modify.
+ * @param       enabled     Whether to resize theDict incrementally.
+ * @discussion  By default, all entries are moved to the new storage when a
+ *              dictionary grows, which makes the insertion triggering the
+ *              resize O(n).
+ *              With incremental resizing, the previous storage is kept and
+ *              a few entries are moved by each subsequent insertion or
+ *              removal, so no single operation is O(n). Lookups do not move
+ *              entries. Both storages are kept in memory until the migration
+ *              is complete.
+ *              Disabling incremental resizing completes any pending
+ *              migration.
+ */
+CF_EXPORT void CFDictionarySetIncrementalResizeEnabled( CFMutableDictionaryRef theDict, Boolean enabled );
+
+/*!
+ * @function    CFDictionarySetValueIndexEnabled
+ * @abstract    Enables or disables the value index of a mutable dictionary.
+ * @param       theDict     The dictionary to modify.
+ * @param       enabled     Whether to maintain the value index.
+ * @result      true if the index is in the requested state. Enabling fails
+ *              if the value equal callback is neither NULL nor CFEqual, as
+ *              values then have no usable hash, or if memory could not be
+ *              allocated.
+ * @discussion  The value index maps each distinct value to the number of
+ *              keys it is associated with, so CFDictionaryContainsValue and
+ *              CFDictionaryGetCountOfValue take constant expected time,
+ *              rather than comparing every value.
+ *              The index is updated on each insertion, replacement and
+ *              removal, which makes them slower, and it uses memory for each
+ *              distinct value. It is disabled by default, and is not copied
+ *              with the dictionary.
+ */
+CF_EXPORT Boolean CFDictionarySetValueIndexEnabled( CFMutableDictionaryRef theDict, Boolean enabled );
+
+/*!
+ * @function    CFDictionaryReserveCapacity
+ * @abstract    Ensures a dictionary can hold a given number of key-value
+ *              pairs without growing.
+ * @param       theDict     The dictionary to modify.
+ * @param       capacity    The total number of key-value pairs theDict shall
+ *                          be able to hold. Smaller capacities than the
+ *                          current one are ignored.
+ */
+CF_EXPORT void CFDictionaryReserveCapacity( CFMutableDictionaryRef theDict, CFIndex capacity );
+
+/*!
+ * @function    CFDictionaryCompact
+ * @abstract    Reduces the storage of a dictionary to the smallest size for
+ *              its current number of key-value pairs.
+ * @param       theDict     The dictionary to modify.
+ * @discussion  This also purges the slots left by removed key-value pairs,
+ *              and completes any pending incremental resize. Use it when
+ *              theDict is not expected to grow again.
+ */
+CF_EXPORT void CFDictionaryCompact( CFMutableDictionaryRef theDict );
+
 CF_EXTERN_C_END
 
 #endif /* CORE_FOUNDATION_CF_MUTABLE_DICTIONARY_H */
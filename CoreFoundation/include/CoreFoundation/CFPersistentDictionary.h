@@ -0,0 +1,209 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      CFPersistentDictionary.h
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ * @discussion  CFPersistentDictionary manages immutable, versioned
+ *              dictionaries, implemented as hash array mapped tries.
+ *              Setting or removing a value never modifies a dictionary, but
+ *              creates a new one in O(log32 n), which shares all the unchanged
+ *              parts of the trie with the original dictionary. Creating a new
+ *              version of a large dictionary is therefore much cheaper than
+ *              copying it, and all versions remain valid.
+ *              Keys and values are retained and released using the
+ *              CFDictionaryKeyCallBacks and CFDictionaryValueCallBacks
+ *              provided at creation time, as with CFDictionary, and new
+ *              versions use the callbacks and allocator of the dictionary they
+ *              are created from.
+ *              As they are immutable, persistent dictionaries may be used
+ *              from several threads without locking.
+ */
+
+#ifndef CORE_FOUNDATION_CF_PERSISTENT_DICTIONARY_H
+#define CORE_FOUNDATION_CF_PERSISTENT_DICTIONARY_H
+
+#include <CoreFoundation/CFBase.h>
+#include <CoreFoundation/CFType.h>
+#include <CoreFoundation/CFDictionary.h>
+
+CF_EXTERN_C_BEGIN
+
+/*!
+ * @typedef     CFPersistentDictionaryRef
+ * @abstract    A reference to a persistent dictionary object.
+ */
+typedef const struct CFPersistentDictionary * CFPersistentDictionaryRef;
+
+/*!
+ * @function    CFPersistentDictionaryGetTypeID
+ * @abstract    Returns the type identifier for the CFPersistentDictionary
+ *              opaque type.
+ * @result      The type identifier for the CFPersistentDictionary opaque type.
+ */
+CF_EXPORT CFTypeID CFPersistentDictionaryGetTypeID( void );
+
+/*!
+ * @function    CFPersistentDictionaryCreate
+ * @abstract    Creates a persistent dictionary containing the specified
+ *              key-value pairs.
+ * @param       allocator       The allocator to use to allocate memory for the
+ *                              new dictionary and all its versions. Pass NULL
+ *                              or kCFAllocatorDefault to use the current
+ *                              default allocator.
+ * @param       keys            A C array of the keys, as for
+ *                              CFDictionaryCreate. May be NULL if numValues
+ *                              is 0.
+ * @param       values          A C array of the values, parallel to keys.
+ *                              May be NULL if numValues is 0.
+ * @param       numValues       The number of key-value pairs.
+ * @param       keyCallBacks    The key callbacks, as for CFDictionaryCreate.
+ * @param       valueCallBacks  The value callbacks, as for
+ *                              CFDictionaryCreate.
+ * @result      A new persistent dictionary, or NULL if there was a problem
+ *              creating the object. Ownership follows the Create Rule.
+ */
+CF_EXPORT CFPersistentDictionaryRef CFPersistentDictionaryCreate( CFAllocatorRef allocator, const void ** keys, const void ** values, CFIndex numValues, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks );
+
+/*!
+ * @function    CFPersistentDictionaryCreateWithDictionary
+ * @abstract    Creates a persistent dictionary with the key-value pairs of a
+ *              dictionary.
+ * @param       allocator   The allocator to use to allocate memory for the new
+ *                          dictionary and all its versions. Pass NULL or
+ *                          kCFAllocatorDefault to use the current default
+ *                          allocator.
+ * @param       theDict     The dictionary to copy. The new dictionary uses the
+ *                          same callbacks as theDict.
+ * @result      A new persistent dictionary, or NULL if there was a problem
+ *              creating the object. Ownership follows the Create Rule.
+ */
+CF_EXPORT CFPersistentDictionaryRef CFPersistentDictionaryCreateWithDictionary( CFAllocatorRef allocator, CFDictionaryRef theDict );
+
+/*!
+ * @function    CFPersistentDictionaryCreateDictionary
+ * @abstract    Creates an immutable dictionary with the key-value pairs of a
+ *              persistent dictionary.
+ * @param       allocator   The allocator to use to allocate memory for the new
+ *                          dictionary. Pass NULL or kCFAllocatorDefault to use
+ *                          the current default allocator.
+ * @param       theDict     The persistent dictionary to copy.
+ * @result      A new dictionary, with the callbacks of theDict, or NULL if
+ *              there was a problem creating the object. Ownership follows
+ *              the Create Rule.
+ */
+CF_EXPORT CFDictionaryRef CFPersistentDictionaryCreateDictionary( CFAllocatorRef allocator, CFPersistentDictionaryRef theDict );
+
+/*!
+ * @function    CFPersistentDictionaryCreateBySettingValue
+ * @abstract    Creates a new version of a persistent dictionary, with the
+ *              value corresponding to a given key set ("add if absent,
+ *              replace if present").
+ * @param       theDict     The persistent dictionary to start from. It is not
+ *                          modified.
+ * @param       key         The key of the value to set.
+ * @param       value       The value to add or replace.
+ * @result      A new persistent dictionary, sharing its storage with theDict,
+ *              or NULL if there was a problem creating the object. If key is
+ *              already associated with value in theDict, theDict itself is
+ *              returned. Ownership follows the Create Rule.
+ * @discussion  If key is already in theDict, the new dictionary keeps the
+ *              existing key object, as CFDictionarySetValue does.
+ */
+CF_EXPORT CFPersistentDictionaryRef CFPersistentDictionaryCreateBySettingValue( CFPersistentDictionaryRef theDict, const void * key, const void * value );
+
+/*!
+ * @function    CFPersistentDictionaryCreateByRemovingValue
+ * @abstract    Creates a new version of a persistent dictionary, without the
+ *              key-value pair for a given key.
+ * @param       theDict     The persistent dictionary to start from. It is not
+ *                          modified.
+ * @param       key         The key of the key-value pair to remove.
+ * @result      A new persistent dictionary, sharing its storage with theDict,
+ *              or NULL if there was a problem creating the object. If key is
+ *              not in theDict, theDict itself is returned. Ownership follows
+ *              the Create Rule.
+ */
+CF_EXPORT CFPersistentDictionaryRef CFPersistentDictionaryCreateByRemovingValue( CFPersistentDictionaryRef theDict, const void * key );
+
+/*!
+ * @function    CFPersistentDictionaryGetCount
+ * @abstract    Returns the number of key-value pairs in a persistent
+ *              dictionary.
+ * @param       theDict     The dictionary to examine.
+ * @result      The number of key-value pairs in theDict.
+ */
+CF_EXPORT CFIndex CFPersistentDictionaryGetCount( CFPersistentDictionaryRef theDict );
+
+/*!
+ * @function    CFPersistentDictionaryContainsKey
+ * @abstract    Returns a Boolean value that indicates whether a given key is
+ *              in a persistent dictionary.
+ * @param       theDict     The dictionary to examine.
+ * @param       key         The key for which to find matches in theDict.
+ * @result      true if key is in theDict, otherwise false.
+ */
+CF_EXPORT Boolean CFPersistentDictionaryContainsKey( CFPersistentDictionaryRef theDict, const void * key );
+
+/*!
+ * @function    CFPersistentDictionaryGetValue
+ * @abstract    Returns the value associated with a given key.
+ * @param       theDict     The dictionary to examine.
+ * @param       key         The key for which to find a match in theDict.
+ * @result      The value associated with key in theDict, or NULL if no
+ *              key-value pair matching key exists. If the value is a Core
+ *              Foundation object, ownership follows the Get Rule.
+ */
+CF_EXPORT const void * CFPersistentDictionaryGetValue( CFPersistentDictionaryRef theDict, const void * key );
+
+/*!
+ * @function    CFPersistentDictionaryGetValueIfPresent
+ * @abstract    Returns a Boolean value that indicates whether a given key is
+ *              in a persistent dictionary, and returns its value indirectly
+ *              if it exists.
+ * @param       theDict     The dictionary to examine.
+ * @param       key         The key for which to find a match in theDict.
+ * @param       value       On return, the value associated with key, if any.
+ *                          May be NULL. If the value is a Core Foundation
+ *                          object, ownership follows the Get Rule.
+ * @result      true if a matching key was found, otherwise false.
+ */
+CF_EXPORT Boolean CFPersistentDictionaryGetValueIfPresent( CFPersistentDictionaryRef theDict, const void * key, const void ** value );
+
+/*!
+ * @function    CFPersistentDictionaryApplyFunction
+ * @abstract    Calls a function once for each key-value pair in a persistent
+ *              dictionary.
+ * @param       theDict     The dictionary to operate upon.
+ * @param       applier     The callback function to call once for each
+ *                          key-value pair in theDict.
+ * @param       context     A pointer-sized program-defined value, which is
+ *                          passed as the third parameter to the applier
+ *                          function.
+ */
+CF_EXPORT void CFPersistentDictionaryApplyFunction( CFPersistentDictionaryRef theDict, CFDictionaryApplierFunction applier, void * context );
+
+CF_EXTERN_C_END
+
+#endif /* CORE_FOUNDATION_CF_PERSISTENT_DICTIONARY_H */
@@ -95,6 +95,11 @@ typedef const struct CFString * CFStringRef;
 
 #include <CoreFoundation/CFDictionary.h>
 
+/* Reserved for the CFSTR macro - Not part of the CFString API */
+#define CF_STRING_CONSTANT_INTERNAL
+#include <CoreFoundation/__private/__CFStringConstant.h>
+#undef CF_STRING_CONSTANT_INTERNAL
+
 /*!
  * @define      CFSTR
  * @abstract    Creates an immutable string from a constant compile-time string.
@@ -114,11 +119,66 @@ typedef const struct CFString * CFStringRef;
  *              You can retain and release values returned from CFSTR in a
  *              balanced fashion, like any other CFString, but you are not
  *              required to do so.
- *              Note: When using this macro as an initializer, you must build
- *              using the -fconstant-cfstrings compiler flag.
- */
+ *              With GCC-compatible C compilers and with C++11, the string
+ *              object is emitted by the compiler with its length and hash
+ *              code, and CFSTR involves no lock and no runtime lookup.
+ *              Constant strings are no longer uniqued: the same literal used
+ *              with CFSTR at different places in the code may yield different
+ *              objects. Code comparing CFSTR results with == used to work, as
+ *              CFStringMakeConstantString returned a single object per
+ *              literal, but may now silently fail. Strings returned by CFSTR
+ *              shall be compared with CFEqual.
+ *              Other compilers fall back to CFStringMakeConstantString.
+ *              The argument must be a string literal.
+ */
+#if defined( __cplusplus ) && __cplusplus >= 201103L
+
+#define CFSTR( _s_ )                                                                    \
+    (                                                                                   \
+        []() -> CFStringRef                                                             \
+        {                                                                               \
+            static constexpr CFHashCode h = ( CF_STRING_CONST_HASHED( _s_ ) )           \
+                                          ? CFStringConstantHash( _s_, sizeof( _s_ ) - 1, 0 ) \
+                                          : 0;                                          \
+            static const CFStringConstantStorage s =                                    \
+            {                                                                           \
+                { reinterpret_cast< uintptr_t >( &CFStringClass ), -1, &CFAllocatorSystemDefault }, \
+                "" _s_ "",                                                              \
+                sizeof( _s_ ) - 1,                                                      \
+                sizeof( _s_ ),                                                          \
+                kCFStringEncodingASCII,                                                 \
+                nullptr,                                                                \
+                h,                                                                      \
+                false,                                                                  \
+                CF_STRING_CONST_HASHED( _s_ )                                           \
+            };                                                                          \
+                                                                                        \
+            return reinterpret_cast< CFStringRef >( &s );                               \
+        }                                                                               \
+        ()                                                                              \
+    )
+
+#elif defined( __GNUC__ ) && !defined( _WIN32 )
+
+#define CFSTR( _s_ )                                                                    \
+    (                                                                                   \
+        __extension__                                                                   \
+        (                                                                               \
+            {                                                                           \
+                static const CFStringConstantStorage CFStringConstant =                 \
+                    CF_STRING_CONST_INITIALIZER( _s_ );                                 \
+                                                                                        \
+                ( CFStringRef )( const void * )&CFStringConstant;                       \
+            }                                                                           \
+        )                                                                               \
+    )
+
+#else
+
 #define CFSTR( _s_ )    CFStringMakeConstantString( _s_ )
 
+#endif
+
 /*!
  * @typedef     
  */
@@ -344,6 +404,28 @@ CF_EXPORT CFTypeID CFStringGetTypeID( void );
  */
 CF_EXPORT CFStringRef CFStringMakeConstantString( const char * cp );
 
+/*!
+ * @function    CFStringCreateUniqued
+ * @abstract    Returns the unique shared string with the contents of a given
+ *              string.
+ * @param       alloc       The allocator to use to allocate memory for the
+ *                          shared string, if it does not exist yet. Pass NULL
+ *                          or kCFAllocatorDefault to use the current default
+ *                          allocator.
+ * @param       theString   The string to unique. It may be mutable.
+ * @result      An immutable string equal to theString. All calls with equal
+ *              strings return the same object, so results may be compared by
+ *              pointer. Ownership follows the Create Rule, but the result is a
+ *              constant which is never deallocated.
+ * @discussion  This is meant for parsers, to share repeated keys such as
+ *              property list or JSON field names. Uniqued strings are kept
+ *              until the program terminates, so this function shall not be
+ *              used for an unbounded set of strings.
+ *              Strings returned by CFStringMakeConstantString are uniqued
+ *              too. Lookups of strings that are already uniqued do not lock.
+ */
+CF_EXPORT CFStringRef CFStringCreateUniqued( CFAllocatorRef alloc, CFStringRef theString );
+
 /*!
  * @function    
  */
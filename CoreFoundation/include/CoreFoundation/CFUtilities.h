@@ -32,10 +32,74 @@
 
 #include <CoreFoundation/CFBase.h>
 #include <CoreFoundation/CFType.h>
+#include <CoreFoundation/CFString.h>
+#include <CoreFoundation/CFDictionary.h>
 
 CF_EXTERN_C_BEGIN
 
+/*!
+ * @constant    kCFLockStatisticsAcquisitionsKey
+ * @abstract    Number of times a lock was acquired (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFLockStatisticsAcquisitionsKey;
+
+/*!
+ * @constant    kCFLockStatisticsContendedAcquisitionsKey
+ * @abstract    Number of acquisitions that had to wait for another thread
+ *              to release the lock (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFLockStatisticsContendedAcquisitionsKey;
+
+/*!
+ * @constant    kCFLockStatisticsWaitTimeKey
+ * @abstract    Total time spent waiting for the lock, in nanoseconds
+ *              (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFLockStatisticsWaitTimeKey;
+
+/*!
+ * @constant    kCFLockStatisticsMaxHoldTimeKey
+ * @abstract    Longest time the lock was held, in nanoseconds (CFNumber).
+ */
+CF_EXPORT const CFStringRef kCFLockStatisticsMaxHoldTimeKey;
 
+/*!
+ * @function    CFLockSetProfilingEnabled
+ * @abstract    Enables or disables profiling of CoreFoundation's internal
+ *              locks.
+ * @param       enabled     Whether lock profiling is enabled.
+ * @discussion  Profiling is disabled by default. While disabled, locks only
+ *              pay for a single extra load on acquisition.
+ */
+CF_EXPORT void CFLockSetProfilingEnabled( Boolean enabled );
+
+/*!
+ * @function    CFLockIsProfilingEnabled
+ * @abstract    Returns whether profiling of CoreFoundation's internal locks
+ *              is enabled.
+ * @result      true if lock profiling is enabled, otherwise false.
+ */
+CF_EXPORT Boolean CFLockIsProfilingEnabled( void );
+
+/*!
+ * @function    CFLockCopyStatistics
+ * @abstract    Returns the statistics collected for CoreFoundation's internal
+ *              locks.
+ * @result      A dictionary whose keys are the names of the locks, and whose
+ *              values are dictionaries containing the kCFLockStatistics keys.
+ *              Ownership follows the Create Rule.
+ * @discussion  Only locks acquired while profiling was enabled are reported.
+ *              Locks sharing the same name, such as the registry locks of
+ *              each CFAllocator, are reported together.
+ */
+CF_EXPORT CFDictionaryRef CFLockCopyStatistics( void );
+
+/*!
+ * @function    CFLockResetStatistics
+ * @abstract    Resets the statistics collected for CoreFoundation's internal
+ *              locks.
+ */
+CF_EXPORT void CFLockResetStatistics( void );
 
 CF_EXTERN_C_END
 
@@ -43,6 +43,7 @@
 #include <CoreFoundation/CFByteOrder.h>
 #include <CoreFoundation/CFCalendar.h>
 #include <CoreFoundation/CFCharacterSet.h>
+#include <CoreFoundation/CFConcurrentDictionary.h>
 #include <CoreFoundation/CFData.h>
 #include <CoreFoundation/CFDate.h>
 #include <CoreFoundation/CFDateFormatter.h>
@@ -65,6 +66,7 @@
 #include <CoreFoundation/CFNull.h>
 #include <CoreFoundation/CFNumber.h>
 #include <CoreFoundation/CFNumberFormatter.h>
+#include <CoreFoundation/CFPersistentDictionary.h>
 #include <CoreFoundation/CFPlugIn.h>
 #include <CoreFoundation/CFPlugInInstance.h>
 #include <CoreFoundation/CFPreferences.h>
@@ -67,6 +67,8 @@ CF_EXPORT struct CFAllocator CFAllocatorNull;
 
 CF_EXPORT CFThreadingKey CFAllocatorDefaultKey;
 
+CF_EXPORT CFSpinLockStatistics CFAllocatorRegistryLockStatistics;
+
 CF_EXPORT void        CFAllocatorConstruct( CFAllocatorRef allocator );
 CF_EXPORT void        CFAllocatorDestruct( CFAllocatorRef allocator );
 CF_EXPORT CFStringRef CFAllocatorCopyDescription( CFAllocatorRef allocator );
@@ -44,11 +44,19 @@ CFIndex CFAtomicDecrement( volatile CFIndex * value );
 int32_t CFAtomicDecrement32( volatile int32_t * value );
 int64_t CFAtomicDecrement64( volatile int64_t * value );
 
+int64_t CFAtomicAdd64( int64_t amount, volatile int64_t * value );
+
 bool CFAtomicCompareAndSwap( CFIndex oldValue, CFIndex newValue, volatile CFIndex * value );
 bool CFAtomicCompareAndSwap32( int32_t oldValue, int32_t newValue, volatile int32_t * value );
 bool CFAtomicCompareAndSwap64( int64_t oldValue, int64_t newValue, volatile int64_t * value );
 bool CFAtomicCompareAndSwapPointer( void * oldValue, void * newValue, void * volatile * value );
 
+CFIndex CFAtomicLoadAcquire( volatile CFIndex * value );
+void    CFAtomicStoreRelease( CFIndex newValue, volatile CFIndex * value );
+
+void * CFAtomicLoadAcquirePointer( void * volatile * value );
+void   CFAtomicStoreReleasePointer( void * newValue, void * volatile * value );
+
 CF_EXTERN_C_END
 
 #endif /* CORE_FOUNDATION___PRIVATE_CF_ATOMIC_H */
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      CFConcurrentDictionary.h
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef CORE_FOUNDATION___PRIVATE_CF_CONCURRENT_DICTIONARY_H
+#define CORE_FOUNDATION___PRIVATE_CF_CONCURRENT_DICTIONARY_H
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <CoreFoundation/__private/__CFRuntime.h>
+#include <CoreFoundation/__private/__CFDictionary.h>
+#include <CoreFoundation/__private/__CFSpinLock.h>
+
+CF_EXTERN_C_BEGIN
+
+#define CF_CONCURRENT_DICTIONARY_STRIPES        ( 32 )
+#define CF_CONCURRENT_DICTIONARY_CACHE_LINE     ( 64 )
+
+/*
+ * Bits 40 and above, as the low bits select the bucket (H1) and the 7 high
+ * bits are the control byte (H2) in the stripe dictionary.
+ */
+#define CF_CONCURRENT_DICTIONARY_STRIPE( _h_ )  ( ( CFIndex )( ( ( _h_ ) >> 40 ) & ( CF_CONCURRENT_DICTIONARY_STRIPES - 1 ) ) )
+
+/*!
+ * @struct      CFConcurrentDictionaryStripe
+ * @discussion  A mutable dictionary and the lock guarding it, padded to a
+ *              cache line so stripes locked by different threads don't share
+ *              one.
+ */
+struct CFConcurrentDictionaryStripe
+{
+    CFSpinLock            lock;
+    struct CFDictionary * dictionary;
+    uint8_t               padding[ CF_CONCURRENT_DICTIONARY_CACHE_LINE - sizeof( CFSpinLock ) - sizeof( struct CFDictionary * ) ];
+};
+
+/*!
+ * @struct      CFConcurrentDictionary
+ * @discussion  Keys are assigned to a stripe by their hash (see
+ *              CF_CONCURRENT_DICTIONARY_STRIPE), which is computed before
+ *              locking the stripe, and passed to the stripe dictionary.
+ *              Values released by an operation are released after the stripe
+ *              is unlocked, so no destructor runs while it is locked.
+ *              The callbacks are also kept here, as removing all values
+ *              replaces the stripe dictionaries.
+ */
+struct CFConcurrentDictionary
+{
+    CFRuntimeBase                       _base;
+    CFDictionaryKeyCallBacks            _keyCallbacks;
+    CFDictionaryValueCallBacks          _valueCallbacks;
+    struct CFConcurrentDictionaryStripe _stripes[ CF_CONCURRENT_DICTIONARY_STRIPES ];
+};
+
+CF_EXPORT void        CFConcurrentDictionaryDestruct( CFConcurrentDictionaryRef d );
+CF_EXPORT CFStringRef CFConcurrentDictionaryCopyDescription( CFConcurrentDictionaryRef d );
+
+CF_EXPORT void CFConcurrentDictionaryInitialize( void );
+
+CF_EXPORT CFTypeID             CFConcurrentDictionaryTypeID;
+CF_EXPORT CFRuntimeClass       CFConcurrentDictionaryClass;
+CF_EXPORT CFSpinLockStatistics CFConcurrentDictionaryLockStatistics;
+
+CF_EXPORT struct CFConcurrentDictionaryStripe * CFConcurrentDictionaryLockStripe( CFConcurrentDictionaryRef d, const void * key, CFHashCode * h );
+CF_EXPORT       void                            CFConcurrentDictionaryUnlockStripe( struct CFConcurrentDictionaryStripe * stripe );
+CF_EXPORT const void                          * CFConcurrentDictionaryRetainValue( CFConcurrentDictionaryRef d, const void * value );
+CF_EXPORT       void                            CFConcurrentDictionaryReleaseValue( CFConcurrentDictionaryRef d, const void * value );
+CF_EXPORT       void                            CFConcurrentDictionaryReleaseKey( CFConcurrentDictionaryRef d, const void * key );
+
+CF_EXTERN_C_END
+
+#endif /* CORE_FOUNDATION___PRIVATE_CF_CONCURRENT_DICTIONARY_H */
@@ -35,24 +35,135 @@
 
 CF_EXTERN_C_BEGIN
 
-struct CFDictionaryItem
+#define CF_DICTIONARY_GROUP_WIDTH       ( 16 )
+#define CF_DICTIONARY_CONTROL_EMPTY     ( ( int8_t )-128 )
+#define CF_DICTIONARY_CONTROL_DELETED   ( ( int8_t )-2 )
+#define CF_DICTIONARY_CONTROL_IS_FULL( _c_ )  ( ( _c_ ) >= 0 )
+#define CF_DICTIONARY_H1( _h_ )         ( _h_ )
+#define CF_DICTIONARY_H2( _h_ )         ( ( int8_t )( ( _h_ ) >> 57 ) )
+#define CF_DICTIONARY_MAX_LOAD( _c_ )   ( ( _c_ ) - ( ( _c_ ) / 8 ) )
+#define CF_DICTIONARY_MIN_LOAD( _c_ )   ( ( _c_ ) / 8 )
+#define CF_DICTIONARY_GROWTH_FACTOR     ( 2 )
+#define CF_DICTIONARY_MIGRATION_STEP    ( 16 )
+#define CF_DICTIONARY_INLINE_CAPACITY   (  8 )
+#define CF_DICTIONARY_BULK_CHUNK        ( 64 )
+#define CF_DICTIONARY_FROZEN_GROUP_LOAD ( 4 )
+#define CF_DICTIONARY_FROZEN_MAX_GROUP  ( 32 )
+#define CF_DICTIONARY_PROBE_HISTOGRAM   ( 16 )
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define CF_DICTIONARY_SSE2              1
+#else
+#define CF_DICTIONARY_SSE2              0
+#endif
+
+/*!
+ * @struct      CFDictionaryBucket
+ * @abstract    Key/value slot, stored inline in the bucket array.
+ * @discussion  A bucket is only valid if its control byte is full.
+ *              The full hash of the key is kept, so resizing never calls
+ *              the hash callback, and lookups only call the equal callback
+ *              on a full hash match.
+ */
+struct CFDictionaryBucket
 {
-    struct CFDictionaryItem * next;
-    const void              * key;
-    const void              * value;
+    const void * key;
+    const void * value;
+    CFHashCode   hash;
 };
 
+/*!
+ * @struct      CFDictionary
+ * @discussion  Dictionaries use open addressing, with one control byte per
+ *              bucket. A control byte is either CF_DICTIONARY_CONTROL_EMPTY,
+ *              CF_DICTIONARY_CONTROL_DELETED, or the 7 high bits of the hash
+ *              of the key stored in the bucket (see CF_DICTIONARY_H2).
+ *              Control bytes are probed by groups of
+ *              CF_DICTIONARY_GROUP_WIDTH, so the first group is mirrored after
+ *              the last control byte.
+ *              Buckets and control bytes are allocated as a single block,
+ *              starting at _buckets. The capacity is either 0 (no storage) or
+ *              a power of two, greater or equal to CF_DICTIONARY_GROUP_WIDTH.
+ *              With incremental resizing, the previous table is kept in the
+ *              _old fields after a resize, and its buckets are migrated by
+ *              CF_DICTIONARY_MIGRATION_STEP on each insertion or removal.
+ *              Lookups probe both tables, so they never modify the
+ *              dictionary.
+ *              Removals shrink the table once the count drops to
+ *              CF_DICTIONARY_MIN_LOAD (see CFDictionaryShrink).
+ *              Dictionaries without a table (_buckets is NULL) keep up to
+ *              CF_DICTIONARY_INLINE_CAPACITY contiguous buckets in _inline,
+ *              and look them up by linear scan. Inserting more entries
+ *              promotes them to a table, and resizing to a capacity of 0
+ *              moves them back inline.
+ *              Larger immutable dictionaries are frozen into a minimal
+ *              perfect hash layout: _buckets holds exactly _count buckets,
+ *              and a key with hash h can only be stored in the bucket at
+ *              CFDictionaryFrozenSlot( h, _seeds[ h >> _seedShift ], _count ),
+ *              so lookups compare a single bucket. There are no control
+ *              bytes.
+ *              Copies share the table or frozen storage of their source:
+ *              _shared then points to the number of dictionaries using the
+ *              storage, which owns the retained keys and values. A shared
+ *              dictionary gets its own storage on its first mutation (see
+ *              CFDictionaryUnshare), and the last one releases the shared
+ *              storage.
+ *              With the value index enabled, _valueIndex maps each distinct
+ *              value to its number of occurrences, as a pointer-sized
+ *              integer. It is kept up to date whenever a value is stored in
+ *              or removed from a bucket (see CFDictionaryIndexValue and
+ *              CFDictionaryUnindexValue).
+ *              _hashCalls and _equalCalls are only counted while dictionary
+ *              profiling is enabled, as lookups would otherwise write to
+ *              dictionaries shared between threads. They are then updated
+ *              atomically, as readers may run concurrently.
+ */
 struct CFDictionary
 {
-    CFRuntimeBase              _base;
-    CFIndex                    _size;
-    CFIndex                    _count;
-    CFDictionaryKeyCallBacks   _keyCallbacks;
-    CFDictionaryValueCallBacks _valueCallbacks;
-    struct CFDictionaryItem ** _items;
-    bool                       _mutable;
+    CFRuntimeBase               _base;
+    CFIndex                     _capacity;
+    CFIndex                     _count;
+    CFIndex                     _growthLeft;
+    CFDictionaryKeyCallBacks    _keyCallbacks;
+    CFDictionaryValueCallBacks  _valueCallbacks;
+    struct CFDictionaryBucket * _buckets;
+    int8_t                    * _controls;
+    struct CFDictionaryBucket * _oldBuckets;
+    int8_t                    * _oldControls;
+    CFIndex                     _oldCapacity;
+    CFIndex                     _migrated;
+    uint32_t                  * _seeds;
+    CFIndex                     _seedShift;
+    volatile CFIndex          * _shared;
+    struct CFDictionary       * _valueIndex;
+    CFIndex                     _resizes;
+    volatile int64_t            _hashCalls;
+    volatile int64_t            _equalCalls;
+    bool                        _frozen;
+    bool                        _incremental;
+    bool                        _mutable;
+    struct CFDictionaryBucket   _inline[ CF_DICTIONARY_INLINE_CAPACITY ];
+};
+
+/*!
+ * @struct      CFDictionaryProbeStatistics
+ * @abstract    Probe lengths of the keys of a dictionary.
+ * @discussion  The probe length of a key is the number of control groups
+ *              examined to find it, so 1 if it is in the group of its hash.
+ *              Inline and frozen keys always have a probe length of 1.
+ *              histogram[ i ] counts keys with a probe length of i + 1, and
+ *              its last element also counts longer probes.
+ */
+struct CFDictionaryProbeStatistics
+{
+    CFIndex histogram[ CF_DICTIONARY_PROBE_HISTOGRAM ];
+    CFIndex total;
+    CFIndex max;
+    CFIndex deleted;
 };
 
+typedef uint32_t CFDictionaryGroupMask;
+
 CF_EXPORT void        CFDictionaryDestruct( CFDictionaryRef d );
 CF_EXPORT bool        CFDictionaryEquals( CFDictionaryRef d1, CFDictionaryRef d2 );
 CF_EXPORT CFStringRef CFDictionaryCopyDescription( CFDictionaryRef d );
@@ -62,17 +173,64 @@ CF_EXPORT void CFDictionaryInitialize( void );
 CF_EXPORT CFTypeID       CFDictionaryTypeID;
 CF_EXPORT CFRuntimeClass CFDictionaryClass;
 
-CF_EXPORT const void              * CFDictionaryCallbackRetain( CFAllocatorRef allocator, const void * value );
-CF_EXPORT       void                CFDictionaryCallbackRelease( CFAllocatorRef allocator, const void * value );
-CF_EXPORT struct CFDictionaryItem * CFDictionaryGetItem( CFDictionaryRef d, const void * key );
-CF_EXPORT bool                      CFDictionaryInsert( struct CFDictionary * d, const void * key, const void * value, bool expandIfNeeded );
-CF_EXPORT void                      CFDictionaryResize( CFDictionaryRef d, CFIndex size );
-CF_EXPORT void                      CFDictionarySwap( CFDictionaryRef d1, CFDictionaryRef d2 );
-CF_EXPORT void                      CFDictionaryAssertMutable( CFDictionaryRef d );
-
-#define CF_DICTIONARY_MAX_LOAD_FACTOR   (  1 )
-#define CF_DICTIONARY_GROWTH_FACTOR     (  2 )
-#define CF_DICTIONARY_DEFAULT_CAPACITY  ( 32 )
+CF_EXPORT volatile CFIndex CFDictionaryProfiling;
+CF_EXPORT volatile double  CFDictionaryProbeLengthThreshold;
+
+CF_EXPORT const void                * CFDictionaryCallbackRetain( CFAllocatorRef allocator, const void * value );
+CF_EXPORT       void                  CFDictionaryCallbackRelease( CFAllocatorRef allocator, const void * value );
+CF_EXPORT       CFHashCode            CFDictionaryCallbackSeededHash( const void * value );
+CF_EXPORT       CFHashCode            CFDictionaryHashKey( CFDictionaryRef d, const void * key );
+CF_EXPORT       CFHashCode            CFDictionaryMixHash( CFHashCode h );
+CF_EXPORT       CFHashCode            CFDictionaryHashInteger( SInt64 key );
+CF_EXPORT       bool                  CFDictionaryKeysEqual( CFDictionaryRef d, const void * key1, const void * key2 );
+CF_EXPORT       bool                  CFDictionaryValuesEqual( CFDictionaryRef d, const void * value1, const void * value2 );
+CF_EXPORT       CFIndex               CFDictionaryProbe( CFDictionaryRef d, const struct CFDictionaryBucket * buckets, const int8_t * controls, CFIndex capacity, const void * key, CFHashCode h );
+CF_EXPORT       CFIndex               CFDictionaryProbeInsertSlot( const int8_t * controls, CFIndex capacity, CFHashCode h );
+CF_EXPORT       CFIndex               CFDictionaryProbeKeyOrInsertSlot( CFDictionaryRef d, const void * key, CFHashCode h, CFIndex * insert );
+CF_EXPORT struct CFDictionaryBucket * CFDictionaryFind( CFDictionaryRef d, const void * key, CFHashCode h );
+CF_EXPORT struct CFDictionaryBucket * CFDictionaryFindFrozen( CFDictionaryRef d, const void * key, CFHashCode h );
+CF_EXPORT       CFIndex               CFDictionaryFrozenSlot( CFHashCode h, uint32_t seed, CFIndex count );
+CF_EXPORT struct CFDictionaryBucket * CFDictionaryNextBucket( CFDictionaryRef d, CFIndex * index );
+CF_EXPORT struct CFDictionaryBucket * CFDictionaryGetBucket( CFDictionaryRef d, const void * key );
+CF_EXPORT struct CFDictionaryBucket * CFDictionaryGetIntegerBucket( CFDictionaryRef d, SInt64 key );
+CF_EXPORT       bool                  CFDictionaryInsert( struct CFDictionary * d, const void * key, const void * value );
+CF_EXPORT       bool                  CFDictionaryInsertWithHash( struct CFDictionary * d, const void * key, const void * value, CFHashCode h );
+CF_EXPORT       bool                  CFDictionaryStoreWithHash( struct CFDictionary * d, const void * key, const void * value, CFHashCode h, bool replace );
+CF_EXPORT       bool                  CFDictionaryFill( struct CFDictionary * d, struct CFDictionaryBucket * bucket, const void * key, const void * value, CFHashCode h );
+CF_EXPORT       void                  CFDictionaryHashBuckets( CFDictionaryRef d, struct CFDictionaryBucket * buckets, const void ** keys, const void ** values, CFIndex count );
+CF_EXPORT       bool                  CFDictionaryInsertBuckets( struct CFDictionary * d, const struct CFDictionaryBucket * buckets, CFIndex count, bool replace );
+CF_EXPORT       bool                  CFDictionaryReserve( struct CFDictionary * d, CFIndex count );
+CF_EXPORT       void                  CFDictionaryErase( struct CFDictionary * d, struct CFDictionaryBucket * bucket );
+CF_EXPORT       void                  CFDictionaryRemove( struct CFDictionary * d, const void * key, CFHashCode h );
+CF_EXPORT       void                  CFDictionaryDetach( struct CFDictionary * d, struct CFDictionaryBucket * bucket );
+CF_EXPORT       void                  CFDictionaryEraseAll( struct CFDictionary * d );
+CF_EXPORT       void                  CFDictionarySetControl( int8_t * controls, CFIndex capacity, CFIndex slot, int8_t control );
+CF_EXPORT       bool                  CFDictionaryResize( struct CFDictionary * d, CFIndex capacity );
+CF_EXPORT       void                  CFDictionaryShrink( struct CFDictionary * d );
+CF_EXPORT       void                  CFDictionaryMigrate( struct CFDictionary * d, CFIndex count );
+CF_EXPORT       void                  CFDictionaryPlace( struct CFDictionary * d, const struct CFDictionaryBucket * bucket );
+CF_EXPORT       CFDictionaryRef       CFDictionaryCreateImmutable( CFAllocatorRef allocator, const void ** keys, const void ** values, CFIndex numValues, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks, bool freeze );
+CF_EXPORT       CFDictionaryRef       CFDictionaryCreateImmutableCopy( CFAllocatorRef allocator, CFDictionaryRef theDict, bool freeze );
+CF_EXPORT       bool                  CFDictionaryFreeze( struct CFDictionary * d, const struct CFDictionaryBucket * buckets, CFIndex count );
+CF_EXPORT       bool                  CFDictionaryShare( struct CFDictionary * d, CFDictionaryRef source );
+CF_EXPORT       void                  CFDictionaryUnshare( struct CFDictionary * d, bool copy );
+CF_EXPORT       void                  CFDictionaryReleaseStorage( CFDictionaryRef d );
+CF_EXPORT       CFIndex               CFDictionaryCapacityForCount( CFIndex count );
+CF_EXPORT       void                  CFDictionaryAssertMutable( CFDictionaryRef d );
+CF_EXPORT       void                  CFDictionaryAssertIntegerKeys( CFDictionaryRef d );
+CF_EXPORT       bool                  CFDictionaryCreateValueIndex( struct CFDictionary * d );
+CF_EXPORT       void                  CFDictionaryIndexValue( struct CFDictionary * d, const void * value );
+CF_EXPORT       void                  CFDictionaryUnindexValue( struct CFDictionary * d, const void * value );
+CF_EXPORT       CFIndex               CFDictionaryGetIndexedValueCount( CFDictionaryRef d, const void * value );
+CF_EXPORT       CFIndex               CFDictionaryProbeLength( CFHashCode h, CFIndex slot, CFIndex capacity );
+CF_EXPORT       void                  CFDictionaryGetProbeStatistics( CFDictionaryRef d, struct CFDictionaryProbeStatistics * stats );
+CF_EXPORT       void                  CFDictionaryAddProbeStatistics( const struct CFDictionaryBucket * buckets, const int8_t * controls, CFIndex capacity, struct CFDictionaryProbeStatistics * stats );
+CF_EXPORT       void                  CFDictionarySample( CFDictionaryRef d );
+
+CF_EXPORT CFDictionaryGroupMask CFDictionaryGroupMatch( const int8_t * group, int8_t h2 );
+CF_EXPORT CFDictionaryGroupMask CFDictionaryGroupMatchEmpty( const int8_t * group );
+CF_EXPORT CFDictionaryGroupMask CFDictionaryGroupMatchEmptyOrDeleted( const int8_t * group );
+CF_EXPORT CFIndex               CFDictionaryGroupMaskFirst( CFDictionaryGroupMask mask );
 
 CF_EXTERN_C_END
 
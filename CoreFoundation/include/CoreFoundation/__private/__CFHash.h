@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      CFHash.h
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef CORE_FOUNDATION___PRIVATE_CF_HASH_H
+#define CORE_FOUNDATION___PRIVATE_CF_HASH_H
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <CoreFoundation/__private/__CFOnce.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+CF_EXTERN_C_BEGIN
+
+#define CF_HASH_ROTL( _x_, _b_ )    ( ( ( _x_ ) << ( _b_ ) ) | ( ( _x_ ) >> ( 64 - ( _b_ ) ) ) )
+
+#define CF_HASH_SIP_ROUND( _v0_, _v1_, _v2_, _v3_ )                             \
+    do                                                                          \
+    {                                                                           \
+        _v0_ += _v1_; _v1_ = CF_HASH_ROTL( _v1_, 13 ); _v1_ ^= _v0_;            \
+        _v0_  = CF_HASH_ROTL( _v0_, 32 );                                       \
+        _v2_ += _v3_; _v3_ = CF_HASH_ROTL( _v3_, 16 ); _v3_ ^= _v2_;            \
+        _v0_ += _v3_; _v3_ = CF_HASH_ROTL( _v3_, 21 ); _v3_ ^= _v0_;            \
+        _v2_ += _v1_; _v1_ = CF_HASH_ROTL( _v1_, 17 ); _v1_ ^= _v2_;            \
+        _v2_  = CF_HASH_ROTL( _v2_, 32 );                                       \
+    }                                                                           \
+    while( 0 )
+
+/*!
+ * @function    CFHashSipHash13
+ * @abstract    Keyed SipHash-1-3 of a byte buffer.
+ * @param       bytes   The bytes to hash
+ * @param       length  The number of bytes to hash
+ * @param       key     The 128-bit key
+ * @discussion  Bytes are read as little-endian words, so the result does not
+ *              depend on the host byte order.
+ */
+CF_EXPORT uint64_t CFHashSipHash13( const void * bytes, size_t length, const uint64_t key[ 2 ] );
+
+/*!
+ * @function    CFHashSeeded
+ * @abstract    Hashes a byte buffer with the per-process seed.
+ * @param       bytes   The bytes to hash
+ * @param       length  The number of bytes to hash
+ * @discussion  The seed is random and created on first use, so hash values
+ *              differ between processes and an attacker cannot predict
+ *              which keys collide.
+ */
+CF_EXPORT CFHashCode CFHashSeeded( const void * bytes, CFIndex length );
+
+CF_EXPORT void CFHashCreateSeed( void );
+CF_EXPORT bool CFHashReadRandomBytes( void * bytes, size_t length );
+
+CF_EXPORT CFOnceToken CFHashSeedOnce;
+CF_EXPORT uint64_t    CFHashSeed[ 2 ];
+
+CF_EXTERN_C_END
+
+#endif /* CORE_FOUNDATION___PRIVATE_CF_HASH_H */
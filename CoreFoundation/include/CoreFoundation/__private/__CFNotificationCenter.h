@@ -32,7 +32,7 @@
 
 #include <CoreFoundation/CoreFoundation.h>
 #include <CoreFoundation/__private/__CFRuntime.h>
-#include <CoreFoundation/__private/__CFSpinLock.h>
+#include <CoreFoundation/__private/__CFOnce.h>
 
 CF_EXTERN_C_BEGIN
 
@@ -46,9 +46,9 @@ CF_EXPORT void CFNotificationCenterInitialize( void );
 CF_EXPORT CFTypeID       CFNotificationCenterTypeID;
 CF_EXPORT CFRuntimeClass CFNotificationCenterClass;
 
-CF_EXPORT CFSpinLock CFNotificationCenterLocalLock;
-CF_EXPORT CFSpinLock CFNotificationCenterDarwinLock;
-CF_EXPORT CFSpinLock CFNotificationCenterDistributedLock;
+CF_EXPORT CFOnceToken CFNotificationCenterLocalOnce;
+CF_EXPORT CFOnceToken CFNotificationCenterDarwinOnce;
+CF_EXPORT CFOnceToken CFNotificationCenterDistributedOnce;
 
 CF_EXPORT CFNotificationCenterRef CFNotificationCenterLocal;
 CF_EXPORT CFNotificationCenterRef CFNotificationCenterDarwin;
@@ -57,6 +57,10 @@ CF_EXPORT CFNotificationCenterRef CFNotificationCenterDistributed;
 CF_EXPORT CFNotificationCenterRef CFNotificationCenterCreate( CFAllocatorRef alloc );
 CF_EXPORT CFStringRef             CFNotificationCenterCopyDescription( CFNotificationCenterRef center );
 
+CF_EXPORT void CFNotificationCenterCreateLocal( void );
+CF_EXPORT void CFNotificationCenterCreateDarwin( void );
+CF_EXPORT void CFNotificationCenterCreateDistributed( void );
+
 CF_EXTERN_C_END
 
 #endif /* CORE_FOUNDATION___PRIVATE_CF_NOTIFICATION_CENTER_H */
@@ -0,0 +1,65 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      CFOnce.h
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef CORE_FOUNDATION___PRIVATE_CF_ONCE_H
+#define CORE_FOUNDATION___PRIVATE_CF_ONCE_H
+
+#include <CoreFoundation/CFBase.h>
+
+CF_EXTERN_C_BEGIN
+
+/*!
+ * @typedef     CFOnceToken
+ * @abstract    Predicate for CFOnce.
+ * @discussion  Tokens shall have static storage and be initialized to
+ *              CF_ONCE_INIT.
+ */
+typedef volatile CFIndex CFOnceToken;
+
+#define CF_ONCE_INIT        ( 0 )
+#define CF_ONCE_RUNNING     ( 1 )
+#define CF_ONCE_DONE        ( 2 )
+
+/*!
+ * @function    CFOnce
+ * @abstract    Executes a function once and only once for the lifetime of
+ *              the program.
+ * @param       once    The predicate guarding the function
+ * @param       func    The function to execute
+ * @discussion  Threads calling CFOnce while the function is executing will
+ *              wait until it has completed. Once the function has completed,
+ *              CFOnce only performs a single acquire load on the predicate,
+ *              so it is safe to use in hot paths, such as getters for lazily
+ *              created singletons.
+ */
+CF_EXPORT void CFOnce( CFOnceToken * once, void ( * func )( void ) );
+
+CF_EXTERN_C_END
+
+#endif /* CORE_FOUNDATION___PRIVATE_CF_ONCE_H */
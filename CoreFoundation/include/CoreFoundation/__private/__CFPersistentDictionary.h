@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      CFPersistentDictionary.h
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifndef CORE_FOUNDATION___PRIVATE_CF_PERSISTENT_DICTIONARY_H
+#define CORE_FOUNDATION___PRIVATE_CF_PERSISTENT_DICTIONARY_H
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <CoreFoundation/__private/__CFRuntime.h>
+
+CF_EXTERN_C_BEGIN
+
+#define CF_PERSISTENT_DICTIONARY_BITS       ( 5 )
+#define CF_PERSISTENT_DICTIONARY_MAX_SHIFT  ( 64 )
+#define CF_PERSISTENT_DICTIONARY_INDEX( _h_, _shift_ )  ( ( uint32_t )( ( ( _h_ ) >> ( _shift_ ) ) & 0x1F ) )
+
+/*!
+ * @struct      CFPersistentDictionaryEntry
+ * @abstract    Key/value pair, with the mixed hash of the key.
+ */
+struct CFPersistentDictionaryEntry
+{
+    const void * key;
+    const void * value;
+    CFHashCode   hash;
+};
+
+/*!
+ * @struct      CFPersistentDictionaryNode
+ * @discussion  Trie node, shared by all the dictionaries and nodes pointing
+ *              to it, and freed when its reference count drops to zero.
+ *              Each node consumes CF_PERSISTENT_DICTIONARY_BITS bits of the
+ *              hash, starting with the low bits at the root. A bit set in
+ *              dataMap means the entry for this index is stored in the node,
+ *              and a bit set in nodeMap that it is in a child node.
+ *              Entries and children are stored after the node, in index
+ *              order, entries first.
+ *              Once the hash is exhausted, keys with the same hash are
+ *              stored in a collision node, with both maps at 0 and
+ *              collisions entries.
+ *              Nodes other than the root hold at least two entries, or a
+ *              child node: removals move a single remaining entry back into
+ *              the parent node.
+ *              Each node retains its keys, values and children.
+ */
+struct CFPersistentDictionaryNode
+{
+    volatile CFIndex rc;
+    uint32_t         dataMap;
+    uint32_t         nodeMap;
+    CFIndex          collisions;
+};
+
+/*!
+ * @struct      CFPersistentDictionary
+ * @discussion  Persistent dictionaries are never modified after creation.
+ *              Setting or removing a value creates a new dictionary, copying
+ *              the nodes on the path to the key and sharing all the others
+ *              with the original dictionary. An empty dictionary has no root.
+ */
+struct CFPersistentDictionary
+{
+    CFRuntimeBase                       _base;
+    CFDictionaryKeyCallBacks            _keyCallbacks;
+    CFDictionaryValueCallBacks          _valueCallbacks;
+    CFIndex                             _count;
+    struct CFPersistentDictionaryNode * _root;
+};
+
+CF_EXPORT void        CFPersistentDictionaryDestruct( CFPersistentDictionaryRef d );
+CF_EXPORT bool        CFPersistentDictionaryEquals( CFPersistentDictionaryRef d1, CFPersistentDictionaryRef d2 );
+CF_EXPORT CFStringRef CFPersistentDictionaryCopyDescription( CFPersistentDictionaryRef d );
+
+CF_EXPORT void CFPersistentDictionaryInitialize( void );
+
+CF_EXPORT CFTypeID       CFPersistentDictionaryTypeID;
+CF_EXPORT CFRuntimeClass CFPersistentDictionaryClass;
+
+CF_EXPORT struct CFPersistentDictionary       * CFPersistentDictionaryCreateEmpty( CFAllocatorRef allocator, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks );
+CF_EXPORT       CFHashCode                      CFPersistentDictionaryHashKey( CFPersistentDictionaryRef d, const void * key );
+CF_EXPORT       bool                            CFPersistentDictionaryKeysEqual( CFPersistentDictionaryRef d, const void * key1, const void * key2 );
+CF_EXPORT       CFIndex                         CFPersistentDictionaryPopCount( uint32_t map );
+CF_EXPORT       CFIndex                         CFPersistentDictionaryNodeEntryCount( const struct CFPersistentDictionaryNode * node );
+CF_EXPORT       CFIndex                         CFPersistentDictionaryNodeChildCount( const struct CFPersistentDictionaryNode * node );
+CF_EXPORT struct CFPersistentDictionaryEntry  * CFPersistentDictionaryNodeEntries( const struct CFPersistentDictionaryNode * node );
+CF_EXPORT struct CFPersistentDictionaryNode  ** CFPersistentDictionaryNodeChildren( const struct CFPersistentDictionaryNode * node );
+CF_EXPORT struct CFPersistentDictionaryNode   * CFPersistentDictionaryNodeCreate( CFPersistentDictionaryRef d, CFIndex entryCount, CFIndex childCount );
+CF_EXPORT struct CFPersistentDictionaryNode   * CFPersistentDictionaryNodeRetain( struct CFPersistentDictionaryNode * node );
+CF_EXPORT       void                            CFPersistentDictionaryNodeRelease( CFPersistentDictionaryRef d, struct CFPersistentDictionaryNode * node );
+CF_EXPORT       void                            CFPersistentDictionaryNodeRetainContents( CFPersistentDictionaryRef d, struct CFPersistentDictionaryNode * node );
+CF_EXPORT struct CFPersistentDictionaryEntry  * CFPersistentDictionaryNodeFind( CFPersistentDictionaryRef d, const struct CFPersistentDictionaryNode * node, const void * key, CFHashCode h );
+CF_EXPORT struct CFPersistentDictionaryNode   * CFPersistentDictionaryNodeMerge( CFPersistentDictionaryRef d, const struct CFPersistentDictionaryEntry * entry1, const struct CFPersistentDictionaryEntry * entry2, CFIndex shift );
+CF_EXPORT       bool                            CFPersistentDictionaryNodeSet( CFPersistentDictionaryRef d, struct CFPersistentDictionaryNode * node, CFIndex shift, const struct CFPersistentDictionaryEntry * entry, struct CFPersistentDictionaryNode ** result, bool * added );
+CF_EXPORT       bool                            CFPersistentDictionaryNodeBuild( CFPersistentDictionaryRef d, struct CFPersistentDictionaryEntry * entries, struct CFPersistentDictionaryEntry * scratch, CFIndex count, CFIndex shift, struct CFPersistentDictionaryNode ** result, CFIndex * added );
+CF_EXPORT       bool                            CFPersistentDictionaryNodeRemove( CFPersistentDictionaryRef d, struct CFPersistentDictionaryNode * node, CFIndex shift, const void * key, CFHashCode h, struct CFPersistentDictionaryNode ** result );
+CF_EXPORT       void                            CFPersistentDictionaryNodeApply( const struct CFPersistentDictionaryNode * node, CFDictionaryApplierFunction applier, void * context );
+CF_EXPORT       void                            CFPersistentDictionaryNodeGetEntries( const struct CFPersistentDictionaryNode * node, struct CFPersistentDictionaryEntry * entries, CFIndex * count );
+CF_EXPORT       bool                            CFPersistentDictionaryNodeContainedIn( CFPersistentDictionaryRef d, const struct CFPersistentDictionaryNode * node, CFPersistentDictionaryRef other );
+
+CF_EXTERN_C_END
+
+#endif /* CORE_FOUNDATION___PRIVATE_CF_PERSISTENT_DICTIONARY_H */
@@ -105,7 +105,7 @@ typedef CFStringRef ( * CFRuntimeCopyDescriptionCallback )( CFTypeRef obj );
  * @field       constructor     The class constructor (may be NULL)
  * @field       destructor      The class destructor (may be NULL)
  */
-typedef struct
+typedef struct CFRuntimeClass
 {
     const char * name;
     size_t       size;
@@ -155,6 +155,19 @@ CF_EXPORT const char * CFRuntimeGetTypeIDName( CFTypeID typeID );
  */
 CF_EXPORT CFTypeRef CFRuntimeCreateInstance( CFAllocatorRef allocator, CFTypeID typeID );
 
+/*!
+ * @function    CFRuntimeCreateInstanceWithExtraBytes
+ * @abstract    Creates a new instance of a CoreFoundation class, with extra
+ *              storage after the instance.
+ * @param       allocator   The allocator to use
+ * @param       typeID      The type ID of the class
+ * @param       extraBytes  The number of bytes to allocate after the instance
+ * @result      The new instance
+ * @discussion  The extra bytes start at the class instance size, and are not
+ *              zero-initialized. They are deallocated with the instance.
+ */
+CF_EXPORT CFTypeRef CFRuntimeCreateInstanceWithExtraBytes( CFAllocatorRef allocator, CFTypeID typeID, CFIndex extraBytes );
+
 /*!
  * @function    CFRuntimeGetInstanceSize
  * @abstract    Gets the instance size of a CoreFoundation type
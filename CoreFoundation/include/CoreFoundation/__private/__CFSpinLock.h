@@ -31,14 +31,63 @@
 #define CORE_FOUNDATION___PRIVATE_CF_SPIN_LOCK_H
 
 #include <CoreFoundation/CFBase.h>
+#include <stdint.h>
+#include <stdbool.h>
 
 CF_EXTERN_C_BEGIN
 
-typedef volatile CFIndex CFSpinLock;
+/*!
+ * @typedef     CFSpinLockStatistics
+ * @abstract    Contention statistics shared by all spinlocks of a given name.
+ * @field       name                    The static name of the lock(s)
+ * @field       acquisitions            Number of acquisitions
+ * @field       contendedAcquisitions   Number of acquisitions that had to wait
+ * @field       waitTime                Total wait time, in nanoseconds
+ * @field       maxHoldTime             Maximum hold time, in nanoseconds
+ * @discussion  Statistics are only collected while lock profiling is enabled.
+ *              They shall have static storage, as they are never unregistered.
+ */
+typedef struct CFSpinLockStatistics
+{
+    const char                           * name;
+    volatile int64_t                       acquisitions;
+    volatile int64_t                       contendedAcquisitions;
+    volatile int64_t                       waitTime;
+    volatile int64_t                       maxHoldTime;
+    volatile CFIndex                       registered;
+    struct CFSpinLockStatistics * volatile next;
+}
+CFSpinLockStatistics;
+
+/*!
+ * @typedef     CFSpinLock
+ * @abstract    Spinlock, optionally reporting to a CFSpinLockStatistics.
+ * @field       value       The lock value
+ * @field       statistics  The statistics the lock reports to (may be NULL)
+ * @field       holdStart   Acquisition time, set by the owner when profiling
+ * @discussion  A zero-initialized CFSpinLock is a valid unlocked spinlock,
+ *              with no statistics.
+ */
+typedef struct
+{
+    volatile CFIndex       value;
+    CFSpinLockStatistics * statistics;
+    uint64_t               holdStart;
+}
+CFSpinLock;
+
+#define CF_SPIN_LOCK_STATISTICS_INIT( _name_ )  { _name_, 0, 0, 0, 0, 0, NULL }
+#define CF_SPIN_LOCK_INIT( _statistics_ )       { 0, _statistics_, 0 }
 
 CF_EXPORT void CFSpinLockLock( CFSpinLock * lock );
 CF_EXPORT void CFSpinLockUnlock( CFSpinLock * lock );
 
+CF_EXPORT volatile CFIndex                CFSpinLockProfiling;
+CF_EXPORT CFSpinLockStatistics * volatile CFSpinLockStatisticsList;
+
+CF_EXPORT uint64_t CFSpinLockGetTime( void );
+CF_EXPORT void     CFSpinLockRegisterStatistics( CFSpinLockStatistics * statistics );
+
 CF_EXTERN_C_END
 
 #endif /* CORE_FOUNDATION___PRIVATE_CF_SPIN_LOCK_H */
@@ -36,6 +36,7 @@
 
 CF_EXTERN_C_BEGIN
 
+/* The layout is mirrored by CFStringConstantStorage, used by CFSTR */
 struct CFString
 {
     CFRuntimeBase    _base;
@@ -44,7 +45,9 @@ struct CFString
     CFIndex          _capacity;
     CFStringEncoding _encoding;
     CFAllocatorRef   _allocator;
+    CFHashCode       _hash;
     bool             _mutable;
+    bool             _hashed;
 };
 
 CF_EXPORT void        CFStringDestruct( CFStringRef str );
@@ -52,7 +55,12 @@ CF_EXPORT CFHashCode  CFStringHash( CFStringRef str );
 CF_EXPORT bool        CFStringEquals( CFStringRef s1, CFStringRef s2 );
 CF_EXPORT CFStringRef CFStringCopyDescription( CFStringRef str );
 
+CF_EXPORT CFHashCode  CFStringHashBytes( const char * bytes, CFIndex length );
+CF_EXPORT CFStringRef CFStringInitConstant( struct CFString * str, const char * cStr, CFIndex length );
+
 CF_EXPORT void CFStringAssertMutable( CFStringRef str );
+CF_EXPORT bool CFStringReserveCapacity( CFMutableStringRef str, CFIndex length );
+CF_EXPORT void CFStringAppendBytes( CFMutableStringRef str, const char * bytes, CFIndex length );
 
 CF_EXPORT void CFStringInitialize( void );
 
@@ -60,26 +68,40 @@ CF_EXPORT CFTypeID       CFStringTypeID;
 CF_EXPORT CFRuntimeClass CFStringClass;
 
 #define CF_STRING_DEFAULT_CAPACITY  ( 1024 )
+#define CF_STRING_FORMAT_BUFFER     ( 256 )
+
+#define CF_STRING_IS_STRING( _cf_ ) ( ( ( const CFRuntimeBase * )( _cf_ ) )->isa == ( uintptr_t )&CFStringClass )
+
+/* Bytes allocated after the object, by CFRuntimeCreateInstanceWithExtraBytes */
+#define CF_STRING_INLINE_BYTES( _str_ ) ( ( char * )( uintptr_t )( ( const struct CFString * )( _str_ ) + 1 ) )
+
+/*
+ * Open-addressing set of uniqued strings, keyed by content.
+ * Lookups are lock-free: slots and the table pointer are published with
+ * release stores, and entries are never removed. Insertions and growth take
+ * CFStringUniquingLock. A grown table replaces the previous one, which is
+ * kept, as readers may still be probing it.
+ */
+struct CFStringUniquingTable
+{
+    CFIndex              capacity;
+    CFStringRef volatile strings[];
+};
+
+#define CF_STRING_UNIQUING_TABLE_INITIAL_CAPACITY   ( 1024 )
+
+CF_EXPORT CFSpinLockStatistics CFStringUniquingLockStatistics;
+
+CF_EXPORT CFSpinLock                              CFStringUniquingLock;
+CF_EXPORT struct CFStringUniquingTable * volatile CFStringUniquedStrings;
+CF_EXPORT CFIndex                                 CFStringUniquedCount;
+
+CF_EXPORT CFStringRef CFStringGetUniqued( CFStringRef str );
+CF_EXPORT CFStringRef CFStringAddUniqued( CFStringRef str );
+CF_EXPORT void        CFStringUniquingTableInsert( struct CFStringUniquingTable * table, CFStringRef str );
 
-CF_EXPORT CFSpinLock    CFStringConstantStringsLock;
-CF_EXPORT CFIndex       CFStringConstantStringsCapacity;
-CF_EXPORT CFStringRef * CFStringConstantStrings;
-
-#define CF_STRING_CONST_DECL( _name_, _cp_ )    \
-    const struct CFString _name_ ## _S =        \
-    {                                           \
-        {                                       \
-            ( uintptr_t )&CFStringClass,        \
-            -1,                                 \
-            NULL                                \
-        },                                      \
-        _cp_,                                   \
-        sizeof( _cp_ ) - 1,                     \
-        sizeof( _cp_ ),                         \
-        kCFStringEncodingASCII,                 \
-        NULL,                                   \
-        false                                   \
-    };                                          \
+#define CF_STRING_CONST_DECL( _name_, _cp_ )                                    \
+    const struct CFString _name_ ## _S = CF_STRING_CONST_INITIALIZER( _cp_ );   \
     const CFStringRef _name_ = &_name_ ## _S
 
 CF_EXTERN_C_END
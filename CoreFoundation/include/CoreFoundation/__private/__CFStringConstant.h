@@ -0,0 +1,180 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @header      CFStringConstant.h
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ * @discussion  Storage and initializers used by CFSTR to emit constant strings
+ *              at compile time. Included by CFString.h only, as the CFSTR
+ *              expansion refers to them. Not part of the public API.
+ */
+
+#ifndef CORE_FOUNDATION___PRIVATE_CF_STRING_CONSTANT_H
+#define CORE_FOUNDATION___PRIVATE_CF_STRING_CONSTANT_H
+
+#ifndef CF_STRING_CONSTANT_INTERNAL
+#error "Include <CoreFoundation/CFString.h> instead"
+#endif
+
+#include <CoreFoundation/CFBase.h>
+#include <stddef.h>
+
+CF_EXTERN_C_BEGIN
+
+/*!
+ * @typedef     CFStringConstantStorage
+ * @abstract    Storage of CFString constants emitted by the compiler.
+ * @discussion  Mirrors the layout of the private CFString structure, and is
+ *              only meant to be initialized by the CFSTR macro.
+ *              It is reserved for internal use and should never be accessed
+ *              directly. Binary compatibility is not guaranteed.
+ */
+typedef struct
+{
+    struct
+    {
+        uintptr_t        isa;
+        volatile CFIndex rc;
+        const void     * allocator;
+    }
+    base;
+    
+    const char * cStr;
+    CFIndex      length;
+    CFIndex      capacity;
+    UInt32       encoding;
+    const void * contentsAllocator;
+    CFHashCode   hash;
+    Boolean      isMutable;
+    Boolean      isHashed;
+}
+CFStringConstantStorage;
+
+/*!
+ * @var         CFStringClass
+ * @abstract    The runtime class of CFString objects.
+ * @discussion  Referenced by the constant strings emitted by CFSTR. It is
+ *              reserved for internal use.
+ */
+struct CFRuntimeClass;
+
+CF_EXPORT struct CFRuntimeClass CFStringClass;
+
+/*!
+ * @var         CFAllocatorSystemDefault
+ * @abstract    The object behind kCFAllocatorSystemDefault.
+ * @discussion  Constant strings report it from CFGetAllocator, like strings
+ *              created by CFStringMakeConstantString. It is reserved for
+ *              internal use.
+ */
+CF_EXPORT struct CFAllocator CFAllocatorSystemDefault;
+
+/*!
+ * @define      CF_STRING_CONST_HASH_MAX_LENGTH
+ * @abstract    Longest literal whose hash is computed by the compiler.
+ * @discussion  Longer constant strings are hashed each time CFHash is called.
+ */
+#define CF_STRING_CONST_HASH_MAX_LENGTH ( 64 )
+
+/*
+ * Compile-time equivalent of CFStringHashBytes for string literals.
+ * Each step is a no-op past the end of the literal, so the expansion has a
+ * fixed depth. The running hash must appear only once per step, or the
+ * expansion grows exponentially.
+ */
+#define CF_STRING_CONST_HASH_IN( _cp_, _i_ ) ( ( _i_ ) < sizeof( _cp_ ) - 1 )
+
+#define CF_STRING_CONST_HASH_STEP( _cp_, _i_, _h_ )                                                      \
+    (                                                                                                   \
+        ( _h_ ) * ( CF_STRING_CONST_HASH_IN( _cp_, _i_ ) ? ( CFHashCode )31 : ( CFHashCode )1 )          \
+      + ( CF_STRING_CONST_HASH_IN( _cp_, _i_ ) ? ( CFHashCode )( unsigned char )( _cp_ )[ ( _i_ ) % sizeof( _cp_ ) ] : ( CFHashCode )0 ) \
+    )
+
+#define CF_STRING_CONST_HASH_8( _cp_, _i_, _h_ )                    \
+    CF_STRING_CONST_HASH_STEP( _cp_, ( _i_ ) + 7,                   \
+    CF_STRING_CONST_HASH_STEP( _cp_, ( _i_ ) + 6,                   \
+    CF_STRING_CONST_HASH_STEP( _cp_, ( _i_ ) + 5,                   \
+    CF_STRING_CONST_HASH_STEP( _cp_, ( _i_ ) + 4,                   \
+    CF_STRING_CONST_HASH_STEP( _cp_, ( _i_ ) + 3,                   \
+    CF_STRING_CONST_HASH_STEP( _cp_, ( _i_ ) + 2,                   \
+    CF_STRING_CONST_HASH_STEP( _cp_, ( _i_ ) + 1,                   \
+    CF_STRING_CONST_HASH_STEP( _cp_, ( _i_ ) + 0, _h_ ) ) ) ) ) ) ) )
+
+#define CF_STRING_CONST_HASH( _cp_ )                                \
+    CF_STRING_CONST_HASH_8( _cp_, 56,                               \
+    CF_STRING_CONST_HASH_8( _cp_, 48,                               \
+    CF_STRING_CONST_HASH_8( _cp_, 40,                               \
+    CF_STRING_CONST_HASH_8( _cp_, 32,                               \
+    CF_STRING_CONST_HASH_8( _cp_, 24,                               \
+    CF_STRING_CONST_HASH_8( _cp_, 16,                               \
+    CF_STRING_CONST_HASH_8( _cp_,  8,                               \
+    CF_STRING_CONST_HASH_8( _cp_,  0, ( CFHashCode )0 ) ) ) ) ) ) ) )
+
+#define CF_STRING_CONST_HASHED( _cp_ ) ( sizeof( _cp_ ) - 1 <= CF_STRING_CONST_HASH_MAX_LENGTH )
+
+/*!
+ * @define      CF_STRING_CONST_INITIALIZER
+ * @abstract    Initializer for a constant CFString with static storage.
+ * @param       _cp_    A string literal
+ * @discussion  Suitable for CFStringConstantStorage as well as for the private
+ *              CFString structure. The length and hash code are computed by
+ *              the compiler.
+ */
+#define CF_STRING_CONST_INITIALIZER( _cp_ )     \
+    {                                           \
+        {                                       \
+            ( uintptr_t )&CFStringClass,        \
+            -1,                                 \
+            &CFAllocatorSystemDefault           \
+        },                                      \
+        "" _cp_ "",                             \
+        sizeof( _cp_ ) - 1,                     \
+        sizeof( _cp_ ),                         \
+        kCFStringEncodingASCII,                 \
+        NULL,                                   \
+        CF_STRING_CONST_HASH( _cp_ ),           \
+        false,                                  \
+        CF_STRING_CONST_HASHED( _cp_ )          \
+    }
+
+CF_EXTERN_C_END
+
+#if defined( __cplusplus ) && __cplusplus >= 201103L
+
+/*!
+ * @function    CFStringConstantHash
+ * @abstract    Compile-time equivalent of CFStringHashBytes, for C++.
+ * @discussion  Recurses once per character, so CFSTR only uses it for
+ *              literals up to CF_STRING_CONST_HASH_MAX_LENGTH characters.
+ *              Longer ones would exceed the constexpr depth limit of the
+ *              compiler, and are hashed at runtime like in C.
+ */
+constexpr CFHashCode CFStringConstantHash( const char * cp, CFIndex length, CFHashCode h )
+{
+    return ( length == 0 ) ? h : CFStringConstantHash( cp + 1, length - 1, h * 31 + ( unsigned char )*( cp ) );
+}
+
+#endif
+
+#endif /* CORE_FOUNDATION___PRIVATE_CF_STRING_CONSTANT_H */
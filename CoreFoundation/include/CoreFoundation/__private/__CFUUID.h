@@ -53,6 +53,8 @@ CF_EXPORT void CFUUIDInitialize( void );
 CF_EXPORT CFTypeID       CFUUIDTypeID;
 CF_EXPORT CFRuntimeClass CFUUIDClass;
 
+CF_EXPORT CFSpinLockStatistics CFUUIDsLockStatistics;
+
 CF_EXPORT CFSpinLock          CFUUIDsLock;
 CF_EXPORT struct CFUUIDList * CFUUIDs;
 CF_EXPORT CFUUIDBytes         CFUUIDNullBytes;
@@ -63,6 +65,7 @@ CF_EXPORT bool        CFUUIDEquals( CFUUIDRef u1, CFUUIDRef u2 );
 CF_EXPORT CFStringRef CFUUIDCopyDescription( CFUUIDRef u );
 CF_EXPORT UInt8       CFUUIDByteFromHexChar( char * s );
 CF_EXPORT CFUUIDRef   CFUUIDGetOrCreate( CFAllocatorRef alloc, CFUUIDBytes bytes, bool returnRetainedIfExist );
+CF_EXPORT bool        CFUUIDReuse( CFUUIDRef u, bool retain );
 
 CF_EXTERN_C_END
 
@@ -0,0 +1,373 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CFConcurrentDictionary.c
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <CoreFoundation/__private/__CFConcurrentDictionary.h>
+#include <CoreFoundation/__private/__CFRuntime.h>
+
+CFTypeID CFConcurrentDictionaryGetTypeID( void )
+{
+    return CFConcurrentDictionaryTypeID;
+}
+
+CFConcurrentDictionaryRef CFConcurrentDictionaryCreate( CFAllocatorRef allocator, CFIndex capacity, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks )
+{
+    struct CFConcurrentDictionary * o;
+    CFIndex                         i;
+    
+    o = ( struct CFConcurrentDictionary * )CFRuntimeCreateInstance( allocator, CFConcurrentDictionaryTypeID );
+    
+    if( o == NULL )
+    {
+        return NULL;
+    }
+    
+    if( keyCallBacks )
+    {
+        o->_keyCallbacks = *( keyCallBacks );
+    }
+    
+    if( valueCallBacks )
+    {
+        o->_valueCallbacks = *( valueCallBacks );
+    }
+    
+    for( i = 0; i < CF_CONCURRENT_DICTIONARY_STRIPES; i++ )
+    {
+        o->_stripes[ i ].lock.statistics = &CFConcurrentDictionaryLockStatistics;
+        o->_stripes[ i ].dictionary      = CFDictionaryCreateMutable( allocator, capacity / CF_CONCURRENT_DICTIONARY_STRIPES, &( o->_keyCallbacks ), &( o->_valueCallbacks ) );
+        
+        if( o->_stripes[ i ].dictionary == NULL )
+        {
+            CFRelease( o );
+            
+            return NULL;
+        }
+    }
+    
+    return o;
+}
+
+CFDictionaryRef CFConcurrentDictionaryCreateSnapshot( CFAllocatorRef allocator, CFConcurrentDictionaryRef theDict )
+{
+    CFMutableDictionaryRef                snapshot;
+    CFDictionaryRef                       copy;
+    CFIndex                               i;
+    CFIndex                               j;
+    struct CFConcurrentDictionaryStripe * stripe;
+    struct CFDictionaryBucket           * bucket;
+    
+    if( theDict == NULL )
+    {
+        return NULL;
+    }
+    
+    snapshot = CFDictionaryCreateMutable( allocator, 0, &( theDict->_keyCallbacks ), &( theDict->_valueCallbacks ) );
+    
+    if( snapshot == NULL )
+    {
+        return NULL;
+    }
+    
+    /* Entries are retained by the snapshot while their stripe is locked */
+    for( i = 0; i < CF_CONCURRENT_DICTIONARY_STRIPES; i++ )
+    {
+        stripe = &( theDict->_stripes[ i ] );
+        j      = 0;
+        
+        CFSpinLockLock( &( stripe->lock ) );
+        
+        while( ( bucket = CFDictionaryNextBucket( stripe->dictionary, &j ) ) )
+        {
+            CFDictionaryInsertWithHash( snapshot, bucket->key, bucket->value, bucket->hash );
+        }
+        
+        CFSpinLockUnlock( &( stripe->lock ) );
+    }
+    
+    copy = CFDictionaryCreateCopy( allocator, snapshot );
+    
+    CFRelease( snapshot );
+    
+    return copy;
+}
+
+CFIndex CFConcurrentDictionaryGetCount( CFConcurrentDictionaryRef theDict )
+{
+    CFIndex i;
+    CFIndex count;
+    
+    if( theDict == NULL )
+    {
+        return 0;
+    }
+    
+    for( count = 0, i = 0; i < CF_CONCURRENT_DICTIONARY_STRIPES; i++ )
+    {
+        CFSpinLockLock( &( theDict->_stripes[ i ].lock ) );
+        
+        count += theDict->_stripes[ i ].dictionary->_count;
+        
+        CFSpinLockUnlock( &( theDict->_stripes[ i ].lock ) );
+    }
+    
+    return count;
+}
+
+Boolean CFConcurrentDictionaryContainsKey( CFConcurrentDictionaryRef theDict, const void * key )
+{
+    struct CFConcurrentDictionaryStripe * stripe;
+    CFHashCode                            h;
+    bool                                  found;
+    
+    if( theDict == NULL )
+    {
+        return false;
+    }
+    
+    stripe = CFConcurrentDictionaryLockStripe( theDict, key, &h );
+    found  = CFDictionaryFind( stripe->dictionary, key, h ) != NULL;
+    
+    CFConcurrentDictionaryUnlockStripe( stripe );
+    
+    return found;
+}
+
+const void * CFConcurrentDictionaryCopyValue( CFConcurrentDictionaryRef theDict, const void * key )
+{
+    struct CFConcurrentDictionaryStripe * stripe;
+    struct CFDictionaryBucket           * bucket;
+    CFHashCode                            h;
+    const void                          * value;
+    
+    if( theDict == NULL )
+    {
+        return NULL;
+    }
+    
+    stripe = CFConcurrentDictionaryLockStripe( theDict, key, &h );
+    bucket = CFDictionaryFind( stripe->dictionary, key, h );
+    value  = ( bucket ) ? CFConcurrentDictionaryRetainValue( theDict, bucket->value ) : NULL;
+    
+    CFConcurrentDictionaryUnlockStripe( stripe );
+    
+    return value;
+}
+
+const void * CFConcurrentDictionaryCopyOrAddValue( CFConcurrentDictionaryRef theDict, const void * key, const void * value )
+{
+    struct CFConcurrentDictionaryStripe * stripe;
+    struct CFDictionaryBucket           * bucket;
+    CFHashCode                            h;
+    
+    if( theDict == NULL )
+    {
+        return NULL;
+    }
+    
+    stripe = CFConcurrentDictionaryLockStripe( theDict, key, &h );
+    bucket = CFDictionaryFind( stripe->dictionary, key, h );
+    
+    if( bucket )
+    {
+        value = bucket->value;
+    }
+    else if( CFDictionaryInsertWithHash( stripe->dictionary, key, value, h ) == false )
+    {
+        CFConcurrentDictionaryUnlockStripe( stripe );
+        
+        return NULL;
+    }
+    
+    value = CFConcurrentDictionaryRetainValue( theDict, value );
+    
+    CFConcurrentDictionaryUnlockStripe( stripe );
+    
+    return value;
+}
+
+Boolean CFConcurrentDictionaryAddValue( CFConcurrentDictionaryRef theDict, const void * key, const void * value )
+{
+    struct CFConcurrentDictionaryStripe * stripe;
+    CFHashCode                            h;
+    bool                                  added;
+    
+    if( theDict == NULL )
+    {
+        return false;
+    }
+    
+    stripe = CFConcurrentDictionaryLockStripe( theDict, key, &h );
+    added  = false;
+    
+    if( CFDictionaryFind( stripe->dictionary, key, h ) == NULL )
+    {
+        added = CFDictionaryInsertWithHash( stripe->dictionary, key, value, h );
+    }
+    
+    CFConcurrentDictionaryUnlockStripe( stripe );
+    
+    return added;
+}
+
+void CFConcurrentDictionarySetValue( CFConcurrentDictionaryRef theDict, const void * key, const void * value )
+{
+    struct CFConcurrentDictionaryStripe * stripe;
+    struct CFDictionaryBucket           * bucket;
+    CFHashCode                            h;
+    const void                          * old;
+    
+    if( theDict == NULL )
+    {
+        return;
+    }
+    
+    stripe = CFConcurrentDictionaryLockStripe( theDict, key, &h );
+    bucket = CFDictionaryFind( stripe->dictionary, key, h );
+    
+    if( bucket == NULL )
+    {
+        CFDictionaryInsertWithHash( stripe->dictionary, key, value, h );
+        CFConcurrentDictionaryUnlockStripe( stripe );
+        
+        return;
+    }
+    
+    old           = bucket->value;
+    bucket->value = CFConcurrentDictionaryRetainValue( theDict, value );
+    
+    CFConcurrentDictionaryUnlockStripe( stripe );
+    CFConcurrentDictionaryReleaseValue( theDict, old );
+}
+
+Boolean CFConcurrentDictionaryReplaceValueIfEqual( CFConcurrentDictionaryRef theDict, const void * key, const void * expected, const void * value )
+{
+    struct CFConcurrentDictionaryStripe * stripe;
+    struct CFDictionaryBucket           * bucket;
+    CFHashCode                            h;
+    const void                          * old;
+    
+    if( theDict == NULL )
+    {
+        return false;
+    }
+    
+    stripe = CFConcurrentDictionaryLockStripe( theDict, key, &h );
+    bucket = CFDictionaryFind( stripe->dictionary, key, h );
+    
+    if( bucket == NULL || CFDictionaryValuesEqual( stripe->dictionary, bucket->value, expected ) == false )
+    {
+        CFConcurrentDictionaryUnlockStripe( stripe );
+        
+        return false;
+    }
+    
+    old           = bucket->value;
+    bucket->value = CFConcurrentDictionaryRetainValue( theDict, value );
+    
+    CFConcurrentDictionaryUnlockStripe( stripe );
+    CFConcurrentDictionaryReleaseValue( theDict, old );
+    
+    return true;
+}
+
+Boolean CFConcurrentDictionaryRemoveValue( CFConcurrentDictionaryRef theDict, const void * key )
+{
+    struct CFConcurrentDictionaryStripe * stripe;
+    struct CFDictionaryBucket           * bucket;
+    struct CFDictionaryBucket             removed;
+    CFHashCode                            h;
+    
+    if( theDict == NULL )
+    {
+        return false;
+    }
+    
+    stripe = CFConcurrentDictionaryLockStripe( theDict, key, &h );
+    
+    if( stripe->dictionary->_oldBuckets )
+    {
+        CFDictionaryMigrate( stripe->dictionary, CF_DICTIONARY_MIGRATION_STEP );
+    }
+    
+    bucket = CFDictionaryFind( stripe->dictionary, key, h );
+    
+    if( bucket == NULL )
+    {
+        CFConcurrentDictionaryUnlockStripe( stripe );
+        
+        return false;
+    }
+    
+    removed = *( bucket );
+    
+    CFDictionaryDetach( stripe->dictionary, bucket );
+    CFDictionaryShrink( stripe->dictionary );
+    CFConcurrentDictionaryUnlockStripe( stripe );
+    CFConcurrentDictionaryReleaseKey( theDict, removed.key );
+    CFConcurrentDictionaryReleaseValue( theDict, removed.value );
+    
+    return true;
+}
+
+void CFConcurrentDictionaryRemoveAllValues( CFConcurrentDictionaryRef theDict )
+{
+    CFIndex                               i;
+    struct CFConcurrentDictionaryStripe * stripe;
+    struct CFDictionary                 * empty;
+    struct CFDictionary                 * removed;
+    
+    if( theDict == NULL )
+    {
+        return;
+    }
+    
+    for( i = 0; i < CF_CONCURRENT_DICTIONARY_STRIPES; i++ )
+    {
+        stripe = &( theDict->_stripes[ i ] );
+        empty  = CFDictionaryCreateMutable( CFGetAllocator( theDict ), 0, &( theDict->_keyCallbacks ), &( theDict->_valueCallbacks ) );
+        
+        CFSpinLockLock( &( stripe->lock ) );
+        
+        if( empty == NULL )
+        {
+            CFDictionaryEraseAll( stripe->dictionary );
+            CFSpinLockUnlock( &( stripe->lock ) );
+            
+            continue;
+        }
+        
+        /* Swaps in an empty dictionary, so the entries are released unlocked */
+        removed            = stripe->dictionary;
+        stripe->dictionary = empty;
+        
+        CFSpinLockUnlock( &( stripe->lock ) );
+        CFRelease( removed );
+    }
+}
@@ -29,9 +29,23 @@
 
 #include <CoreFoundation/CoreFoundation.h>
 #include <CoreFoundation/__private/__CFDictionary.h>
+#include <CoreFoundation/__private/__CFString.h>
 #include <CoreFoundation/__private/__CFRuntime.h>
+#include <CoreFoundation/__private/__CFAtomic.h>
 #include <string.h>
 
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsCountKey,                 "Count" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsCapacityKey,              "Capacity" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsLoadFactorKey,            "LoadFactor" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsDeletedCountKey,          "DeletedCount" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsLayoutKey,                "Layout" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsProbeLengthHistogramKey,  "ProbeLengthHistogram" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsAverageProbeLengthKey,    "AverageProbeLength" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsMaxProbeLengthKey,        "MaxProbeLength" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsResizeCountKey,           "ResizeCount" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsHashCallbackCountKey,     "HashCallbackCount" );
+CF_STRING_CONST_DECL( kCFDictionaryDiagnosticsEqualCallbackCountKey,    "EqualCallbackCount" );
+
 CFTypeID CFDictionaryGetTypeID( void )
 {
     return CFDictionaryTypeID;
@@ -39,96 +53,22 @@ CFTypeID CFDictionaryGetTypeID( void )
 
 CFDictionaryRef CFDictionaryCreate( CFAllocatorRef allocator, const void ** keys, const void ** values, CFIndex numValues, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks )
 {
-    struct CFDictionary * o;
-    CFIndex               i;
-    CFIndex               capacity;
-    
-    o = ( struct CFDictionary * )CFRuntimeCreateInstance( allocator, CFDictionaryTypeID );
-    
-    if( o == NULL )
-    {
-        return NULL;
-    }
-    
-    capacity  = ( numValues > 0 ) ? numValues : 1;
-    o->_items = CFAllocatorAllocate( allocator, capacity * ( CFIndex )sizeof( struct CFDictionaryItem * ), 0 );
-    
-    if( o->_items == NULL )
-    {
-        CFRelease( o );
-        
-        return NULL;
-    }
-    
-    o->_size = capacity;
-    
-    if( keyCallBacks )
-    {
-        o->_keyCallbacks = *( keyCallBacks );
-    }
-    
-    if( valueCallBacks )
-    {
-        o->_valueCallbacks = *( valueCallBacks );
-    }
-    
-    for( i = 0; i < numValues; i++ )
-    {
-        if( CFDictionaryInsert( o, keys[ i ], values[ i ], false ) == false )
-        {
-            CFRelease( o );
-            
-            return NULL;
-        }
-    }
-    
-    return o;
+    return CFDictionaryCreateImmutable( allocator, keys, values, numValues, keyCallBacks, valueCallBacks, false );
+}
+
+CFDictionaryRef CFDictionaryCreateFrozen( CFAllocatorRef allocator, const void ** keys, const void ** values, CFIndex numValues, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks )
+{
+    return CFDictionaryCreateImmutable( allocator, keys, values, numValues, keyCallBacks, valueCallBacks, true );
 }
 
 CFDictionaryRef CFDictionaryCreateCopy( CFAllocatorRef allocator, CFDictionaryRef theDict )
 {
-    struct CFDictionary     * o;
-    struct CFDictionaryItem * item;
-    CFIndex                   i;
-    
-    if( theDict == NULL )
-    {
-        return NULL;
-    }
-    
-    o = ( struct CFDictionary * )CFRuntimeCreateInstance( allocator, CFDictionaryTypeID );
-    
-    if( o == NULL )
-    {
-        return NULL;
-    }
-    
-    o->_items = CFAllocatorAllocate( allocator, theDict->_size * ( CFIndex )sizeof( struct CFDictionaryItem * ), 0 );
-    
-    if( o->_items == NULL )
-    {
-        CFRelease( o );
-        
-        return NULL;
-    }
-    
-    o->_size            = theDict->_size;
-    o->_keyCallbacks    = theDict->_keyCallbacks;
-    o->_valueCallbacks  = theDict->_valueCallbacks;
-    
-    for( i = 0; i < theDict->_size; i++ )
-    {
-        item = theDict->_items[ i ];
-        
-        while( item )
-        {
-            CFDictionaryInsert( o, item->key, item->value, false );
-            
-            item = item->next;
-        }
-    }
-    
-    return o;
+    return CFDictionaryCreateImmutableCopy( allocator, theDict, false );
+}
+
+CFDictionaryRef CFDictionaryCreateFrozenCopy( CFAllocatorRef allocator, CFDictionaryRef theDict )
+{
+    return CFDictionaryCreateImmutableCopy( allocator, theDict, true );
 }
 
 Boolean CFDictionaryContainsKey( CFDictionaryRef theDict, const void * key )
@@ -138,35 +78,31 @@ Boolean CFDictionaryContainsKey( CFDictionaryRef theDict, const void * key )
         return false;
     }
     
-    return CFDictionaryGetItem( theDict, key ) != NULL;
+    return CFDictionaryGetBucket( theDict, key ) != NULL;
 }
 
 Boolean CFDictionaryContainsValue( CFDictionaryRef theDict, const void * value )
 {
-    CFIndex                   i;
-    struct CFDictionaryItem * item;
+    CFIndex                     i;
+    struct CFDictionaryBucket * bucket;
     
-    if( theDict == NULL || theDict->_items == NULL )
+    if( theDict == NULL )
     {
         return false;
     }
     
-    for( i = 0; i < theDict->_size; i++ )
+    if( theDict->_valueIndex )
     {
-        item = theDict->_items[ i ];
-        
-        while( item )
+        return CFDictionaryGetIndexedValueCount( theDict, value ) > 0;
+    }
+    
+    i = 0;
+    
+    while( ( bucket = CFDictionaryNextBucket( theDict, &i ) ) )
+    {
+        if( CFDictionaryValuesEqual( theDict, value, bucket->value ) )
         {
-            if( item->value == value )
-            {
-                return true;
-            }
-            else if( theDict->_valueCallbacks.equal && theDict->_valueCallbacks.equal( value, item->value ) )
-            {
-                return true;
-            }
-            
-            item = item->next;
+            return true;
         }
     }
     
@@ -195,33 +131,28 @@ CFIndex CFDictionaryGetCountOfKey( CFDictionaryRef theDict, const void * key )
 
 CFIndex CFDictionaryGetCountOfValue( CFDictionaryRef theDict, const void * value )
 {
-    CFIndex                   i;
-    CFIndex                   c;
-    struct CFDictionaryItem * item;
+    CFIndex                     i;
+    CFIndex                     c;
+    struct CFDictionaryBucket * bucket;
     
-    if( theDict == NULL || theDict->_items == NULL )
+    if( theDict == NULL )
     {
         return 0;
     }
     
+    if( theDict->_valueIndex )
+    {
+        return CFDictionaryGetIndexedValueCount( theDict, value );
+    }
+    
     c = 0;
+    i = 0;
     
-    for( i = 0; i < theDict->_size; i++ )
+    while( ( bucket = CFDictionaryNextBucket( theDict, &i ) ) )
     {
-        item = theDict->_items[ i ];
-        
-        while( item )
+        if( CFDictionaryValuesEqual( theDict, value, bucket->value ) )
         {
-            if( item->value == value )
-            {
-                c++;
-            }
-            else if( theDict->_valueCallbacks.equal && theDict->_valueCallbacks.equal( value, item->value ) )
-            {
-                c++;
-            }
-            
-            item = item->next;
+            c++;
         }
     }
     
@@ -230,97 +161,273 @@ CFIndex CFDictionaryGetCountOfValue( CFDictionaryRef theDict, const void * value
 
 void CFDictionaryGetKeysAndValues( CFDictionaryRef theDict, const void ** keys, const void ** values )
 {
-    CFIndex                   i;
-    CFIndex                   c;
-    struct CFDictionaryItem * item;
+    CFIndex                     i;
+    CFIndex                     c;
+    struct CFDictionaryBucket * bucket;
     
-    if( theDict == NULL || theDict->_items == NULL )
+    if( theDict == NULL )
     {
         return;
     }
     
     c = 0;
+    i = 0;
     
-    for( i = 0; i < theDict->_size; i++ )
+    while( ( bucket = CFDictionaryNextBucket( theDict, &i ) ) )
     {
-        item = theDict->_items[ i ];
+        if( keys )
+        {
+            keys[ c ] = bucket->key;
+        }
         
-        while( item )
+        if( values )
         {
-            if( keys )
-            {
-                keys[ c ] = item->key;
-            }
-            
-            if( values )
-            {
-                values[ c ] = item->value;
-            }
-            
-            item = item->next;
-            
-            c++;
+            values[ c ] = bucket->value;
         }
+        
+        c++;
     }
 }
 
 const void * CFDictionaryGetValue( CFDictionaryRef theDict, const void * key )
 {
-    struct CFDictionaryItem * item;
+    struct CFDictionaryBucket * bucket;
     
     if( theDict == NULL )
     {
         return NULL;
     }
     
-    item = CFDictionaryGetItem( theDict, key );
+    bucket = CFDictionaryGetBucket( theDict, key );
     
-    return ( item ) ? item->value : NULL;
+    return ( bucket ) ? bucket->value : NULL;
 }
 
 Boolean CFDictionaryGetValueIfPresent( CFDictionaryRef theDict, const void * key, const void ** value )
 {
-    struct CFDictionaryItem * item;
+    struct CFDictionaryBucket * bucket;
     
     if( theDict == NULL )
     {
         return false;
     }
     
-    item = CFDictionaryGetItem( theDict, key );
+    bucket = CFDictionaryGetBucket( theDict, key );
     
-    if( item == NULL )
+    if( bucket == NULL )
     {
         return false;
     }
     
     if( value )
     {
-        *( value ) = item->value;
+        *( value ) = bucket->value;
     }
     
     return true;
 }
 
+const void * CFDictionaryGetValueForIntegerKey( CFDictionaryRef theDict, SInt64 key )
+{
+    struct CFDictionaryBucket * bucket;
+    
+    bucket = CFDictionaryGetIntegerBucket( theDict, key );
+    
+    return ( bucket ) ? bucket->value : NULL;
+}
+
+Boolean CFDictionaryGetValueForIntegerKeyIfPresent( CFDictionaryRef theDict, SInt64 key, const void ** value )
+{
+    struct CFDictionaryBucket * bucket;
+    
+    bucket = CFDictionaryGetIntegerBucket( theDict, key );
+    
+    if( bucket == NULL )
+    {
+        return false;
+    }
+    
+    if( value )
+    {
+        *( value ) = bucket->value;
+    }
+    
+    return true;
+}
+
+Boolean CFDictionaryContainsIntegerKey( CFDictionaryRef theDict, SInt64 key )
+{
+    return CFDictionaryGetIntegerBucket( theDict, key ) != NULL;
+}
+
+const void * CFDictionaryGetValueForCString( CFDictionaryRef theDict, const char * cStr, CFIndex length )
+{
+    struct CFString             key;
+    struct CFDictionaryBucket * bucket;
+    
+    if( theDict == NULL || cStr == NULL )
+    {
+        return NULL;
+    }
+    
+    /* Hashed and compared as any CFString key, through the key callbacks */
+    CFStringInitConstant( &key, cStr, ( length < 0 ) ? ( CFIndex )strlen( cStr ) : length );
+    
+    bucket = CFDictionaryGetBucket( theDict, &key );
+    
+    return ( bucket ) ? bucket->value : NULL;
+}
+
+Boolean CFDictionaryContainsCStringKey( CFDictionaryRef theDict, const char * cStr, CFIndex length )
+{
+    struct CFString key;
+    
+    if( theDict == NULL || cStr == NULL )
+    {
+        return false;
+    }
+    
+    CFStringInitConstant( &key, cStr, ( length < 0 ) ? ( CFIndex )strlen( cStr ) : length );
+    
+    return CFDictionaryGetBucket( theDict, &key ) != NULL;
+}
+
 void CFDictionaryApplyFunction( CFDictionaryRef theDict, CFDictionaryApplierFunction applier, void * context )
 {
-    CFIndex                   i;
-    struct CFDictionaryItem * item;
+    CFIndex                     i;
+    struct CFDictionaryBucket * bucket;
     
-    if( theDict == NULL || theDict->_items == NULL || applier == NULL )
+    if( theDict == NULL || applier == NULL )
     {
         return;
     }
     
-    for( i = 0; i < theDict->_size; i++ )
+    i = 0;
+    
+    while( ( bucket = CFDictionaryNextBucket( theDict, &i ) ) )
+    {
+        applier( bucket->key, bucket->value, context );
+    }
+}
+
+CFDictionaryRef CFDictionaryCopyDiagnostics( CFDictionaryRef theDict )
+{
+    CFMutableDictionaryRef             info;
+    CFMutableDictionaryRef             histogram;
+    struct CFDictionaryProbeStatistics stats;
+    CFStringRef                        keys[ 7 ];
+    int64_t                            values[ 7 ];
+    CFIndex                            capacity;
+    double                             load;
+    double                             average;
+    int64_t                            length;
+    int64_t                            count;
+    CFNumberRef                        n;
+    CFNumberRef                        l;
+    CFStringRef                        layout;
+    int                                i;
+    
+    if( theDict == NULL )
+    {
+        return NULL;
+    }
+    
+    info      = CFDictionaryCreateMutable( NULL, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks );
+    histogram = CFDictionaryCreateMutable( NULL, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks );
+    
+    if( info == NULL || histogram == NULL )
     {
-        item = theDict->_items[ i ];
+        CFRelease( info );
+        CFRelease( histogram );
         
-        while( item )
+        return NULL;
+    }
+    
+    CFDictionaryGetProbeStatistics( theDict, &stats );
+    
+    if( theDict->_frozen )
+    {
+        capacity = theDict->_count;
+        layout   = CFSTR( "Frozen" );
+    }
+    else if( theDict->_buckets == NULL )
+    {
+        capacity = CF_DICTIONARY_INLINE_CAPACITY;
+        layout   = CFSTR( "Inline" );
+    }
+    else
+    {
+        capacity = theDict->_capacity;
+        layout   = CFSTR( "Table" );
+    }
+    
+    keys[ 0 ] = kCFDictionaryDiagnosticsCountKey;
+    keys[ 1 ] = kCFDictionaryDiagnosticsCapacityKey;
+    keys[ 2 ] = kCFDictionaryDiagnosticsDeletedCountKey;
+    keys[ 3 ] = kCFDictionaryDiagnosticsMaxProbeLengthKey;
+    keys[ 4 ] = kCFDictionaryDiagnosticsResizeCountKey;
+    keys[ 5 ] = kCFDictionaryDiagnosticsHashCallbackCountKey;
+    keys[ 6 ] = kCFDictionaryDiagnosticsEqualCallbackCountKey;
+    
+    values[ 0 ] = theDict->_count;
+    values[ 1 ] = capacity;
+    values[ 2 ] = stats.deleted;
+    values[ 3 ] = stats.max;
+    values[ 4 ] = theDict->_resizes;
+    values[ 5 ] = theDict->_hashCalls;
+    values[ 6 ] = theDict->_equalCalls;
+    
+    for( i = 0; i < 7; i++ )
+    {
+        n = CFNumberCreate( NULL, kCFNumberSInt64Type, &( values[ i ] ) );
+        
+        CFDictionarySetValue( info, keys[ i ], n );
+        CFRelease( n );
+    }
+    
+    load    = ( capacity ) ? ( double )( theDict->_count ) / ( double )capacity : 0;
+    average = ( theDict->_count ) ? ( double )( stats.total ) / ( double )( theDict->_count ) : 0;
+    
+    n = CFNumberCreate( NULL, kCFNumberDoubleType, &load );
+    
+    CFDictionarySetValue( info, kCFDictionaryDiagnosticsLoadFactorKey, n );
+    CFRelease( n );
+    
+    n = CFNumberCreate( NULL, kCFNumberDoubleType, &average );
+    
+    CFDictionarySetValue( info, kCFDictionaryDiagnosticsAverageProbeLengthKey, n );
+    CFRelease( n );
+    
+    for( i = 0; i < CF_DICTIONARY_PROBE_HISTOGRAM; i++ )
+    {
+        if( stats.histogram[ i ] == 0 )
         {
-            applier( item->key, item->value, context );
-            
-            item = item->next;
+            continue;
         }
+        
+        length = i + 1;
+        count  = stats.histogram[ i ];
+        l      = CFNumberCreate( NULL, kCFNumberSInt64Type, &length );
+        n      = CFNumberCreate( NULL, kCFNumberSInt64Type, &count );
+        
+        CFDictionarySetValue( histogram, l, n );
+        CFRelease( l );
+        CFRelease( n );
     }
+    
+    CFDictionarySetValue( info, kCFDictionaryDiagnosticsProbeLengthHistogramKey, histogram );
+    CFDictionarySetValue( info, kCFDictionaryDiagnosticsLayoutKey, layout );
+    CFRelease( histogram );
+    
+    return info;
+}
+
+void CFDictionarySetProfilingEnabled( Boolean enabled )
+{
+    CFAtomicStoreRelease( ( enabled ) ? 1 : 0, &CFDictionaryProfiling );
+}
+
+void CFDictionarySetProbeLengthWarningThreshold( double threshold )
+{
+    CFDictionaryProbeLengthThreshold = threshold;
 }
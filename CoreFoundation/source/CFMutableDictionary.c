@@ -42,18 +42,7 @@ CFMutableDictionaryRef CFDictionaryCreateMutable( CFAllocatorRef allocator, CFIn
         return NULL;
     }
     
-    capacity  = ( capacity > 0 ) ? capacity : CF_DICTIONARY_DEFAULT_CAPACITY;
-    o->_items = CFAllocatorAllocate( allocator, capacity * ( CFIndex )sizeof( struct CFDictionaryItem * ), 0 );
-    
-    if( o->_items == NULL )
-    {
-        CFRelease( o );
-        
-        return NULL;
-    }
-    
     o->_mutable = true;
-    o->_size    = capacity;
     
     if( keyCallBacks )
     {
@@ -65,33 +54,66 @@ CFMutableDictionaryRef CFDictionaryCreateMutable( CFAllocatorRef allocator, CFIn
         o->_valueCallbacks = *( valueCallBacks );
     }
     
+    /* Without a large enough capacity hint, entries are first stored inline */
+    capacity = CFDictionaryCapacityForCount( capacity );
+    
+    if( capacity > 0 && CFDictionaryResize( o, capacity ) == false )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
     return o;
 }
 
+CFMutableDictionaryRef CFDictionaryCreateMutableWithIntegerKeys( CFAllocatorRef allocator, CFIndex capacity, const CFDictionaryValueCallBacks * valueCallBacks )
+{
+    /* No key callbacks: keys are stored as is, and hashed by the mix alone */
+    return CFDictionaryCreateMutable( allocator, capacity, NULL, valueCallBacks );
+}
+
 CFMutableDictionaryRef CFDictionaryCreateMutableCopy( CFAllocatorRef allocator, CFIndex capacity, CFDictionaryRef theDict )
 {
-    CFMutableDictionaryRef    o;
-    CFIndex                   i;
-    struct CFDictionaryItem * item;
+    struct CFDictionary       * o;
+    CFIndex                     i;
+    struct CFDictionaryBucket * bucket;
     
     if( theDict == NULL )
     {
         return NULL;
     }
     
-    capacity = ( capacity < theDict->_size ) ? theDict->_size : capacity;
+    o = ( struct CFDictionary * )CFDictionaryCreateMutable( allocator, 0, &( theDict->_keyCallbacks ), &( theDict->_valueCallbacks ) );
     
-    o = CFDictionaryCreateMutable( allocator, capacity, &( theDict->_keyCallbacks ), &( theDict->_valueCallbacks ) );
+    if( o == NULL )
+    {
+        return NULL;
+    }
     
-    for( i = 0; i < theDict->_size; i++ )
+    /* Without room for more entries, the copy is likely to stay unmodified */
+    if( capacity <= theDict->_count && CFDictionaryShare( o, theDict ) )
     {
-        item = theDict->_items[ i ];
+        return o;
+    }
+    
+    if( CFDictionaryReserve( o, ( capacity < theDict->_count ) ? theDict->_count : capacity ) == false )
+    {
+        CFRelease( o );
         
-        while( item )
+        return NULL;
+    }
+    
+    /* Same key callbacks, so the cached hashes are valid for the copy */
+    i = 0;
+    
+    while( ( bucket = CFDictionaryNextBucket( theDict, &i ) ) )
+    {
+        if( CFDictionaryInsertWithHash( o, bucket->key, bucket->value, bucket->hash ) == false )
         {
-            CFDictionaryInsert( o, item->key, item->value, false );
+            CFRelease( o );
             
-            item = item->next;
+            return NULL;
         }
     }
     
@@ -100,7 +122,7 @@ CFMutableDictionaryRef CFDictionaryCreateMutableCopy( CFAllocatorRef allocator,
 
 void CFDictionaryAddValue( CFMutableDictionaryRef theDict, const void * key, const void * value )
 {
-    struct CFDictionaryItem * item;
+    CFHashCode h;
     
     if( theDict == NULL )
     {
@@ -108,134 +130,90 @@ void CFDictionaryAddValue( CFMutableDictionaryRef theDict, const void * key, con
     }
     
     CFDictionaryAssertMutable( theDict );
+    CFDictionaryUnshare( theDict, true );
     
-    item = CFDictionaryGetItem( theDict, key );
+    h = CFDictionaryHashKey( theDict, key );
     
-    if( item == NULL )
+    if( CFDictionaryFind( theDict, key, h ) == NULL )
     {
-        CFDictionaryInsert( theDict, key, value, true );
+        CFDictionaryInsertWithHash( theDict, key, value, h );
     }
 }
 
-void CFDictionaryRemoveAllValues( CFMutableDictionaryRef theDict )
+void CFDictionaryAddValues( CFMutableDictionaryRef theDict, const void ** keys, const void ** values, CFIndex count )
 {
+    struct CFDictionaryBucket buckets[ CF_DICTIONARY_BULK_CHUNK ];
     CFIndex                   i;
-    struct CFDictionaryItem * item;
-    struct CFDictionaryItem * del;
-    CFAllocatorRef            alloc;
+    CFIndex                   n;
     
-    if( theDict == NULL || theDict->_items == NULL )
+    if( theDict == NULL || count <= 0 )
     {
         return;
     }
     
     CFDictionaryAssertMutable( theDict );
+    CFDictionaryUnshare( theDict, true );
     
-    alloc = CFGetAllocator( theDict );
+    /* Grows once, for the case where none of the keys is present */
+    if( CFDictionaryReserve( theDict, theDict->_count + count ) == false )
+    {
+        return;
+    }
     
-    for( i = 0; i < theDict->_size; i++ )
+    for( i = 0; i < count; i += n )
     {
-        item                 = theDict->_items[ i ];
-        theDict->_items[ i ] = NULL;
+        n = ( count - i < CF_DICTIONARY_BULK_CHUNK ) ? count - i : CF_DICTIONARY_BULK_CHUNK;
+        
+        CFDictionaryHashBuckets( theDict, buckets, keys + i, values + i, n );
         
-        while( item )
+        if( CFDictionaryInsertBuckets( theDict, buckets, n, false ) == false )
         {
-            del  = item;
-            item = item->next;
-            
-            if( theDict->_keyCallbacks.release )
-            {
-                theDict->_keyCallbacks.release( alloc, del->key );
-            }
-            
-            if( theDict->_valueCallbacks.release )
-            {
-                theDict->_valueCallbacks.release( alloc, del->value );
-            }
-            
-            CFAllocatorDeallocate( alloc, del );
-            
-            theDict->_count--;
+            return;
         }
     }
 }
 
-void CFDictionaryRemoveValue( CFMutableDictionaryRef theDict, const void * key )
+void CFDictionaryRemoveAllValues( CFMutableDictionaryRef theDict )
 {
-    CFHashCode                h;
-    struct CFDictionaryItem * item;
-    struct CFDictionaryItem * prev;
-    CFAllocatorRef            alloc;
-    
-    if( theDict == NULL || theDict->_items == NULL )
+    if( theDict == NULL )
     {
         return;
     }
     
     CFDictionaryAssertMutable( theDict );
-    
-    if( theDict->_keyCallbacks.hash )
-    {
-        h = theDict->_keyCallbacks.hash( key );
-    }
-    else
+    CFDictionaryEraseAll( theDict );
+}
+
+void CFDictionaryRemoveValue( CFMutableDictionaryRef theDict, const void * key )
+{
+    if( theDict == NULL )
     {
-        h = ( uint64_t )key;
+        return;
     }
     
-    h     = h % ( CFHashCode )( theDict->_size );
-    item  = theDict->_items[ h ];
-    alloc = CFGetAllocator( theDict );
-    prev  = NULL;
-    
-    while( item )
+    CFDictionaryAssertMutable( theDict );
+    CFDictionaryUnshare( theDict, true );
+    CFDictionaryRemove( theDict, key, CFDictionaryHashKey( theDict, key ) );
+}
+
+void CFDictionaryRemoveValueForIntegerKey( CFMutableDictionaryRef theDict, SInt64 key )
+{
+    if( theDict == NULL )
     {
-        if( theDict->_keyCallbacks.equal == NULL && key != item->key )
-        {
-            prev = item;
-            item = item->next;
-            
-            continue;
-        }
-        else if( key != item->key && theDict->_keyCallbacks.equal( key, item->key ) == false )
-        {
-            prev = item;
-            item = item->next;
-            
-            continue;
-        }
-        
-        if( prev == NULL )
-        {
-            theDict->_items[ h ] = item->next;
-        }
-        else
-        {
-            prev->next = item->next;
-        }
-        
-        if( theDict->_keyCallbacks.release )
-        {
-            theDict->_keyCallbacks.release( alloc, item->key );
-        }
-        
-        if( theDict->_valueCallbacks.release )
-        {
-            theDict->_valueCallbacks.release( alloc, item->value );
-        }
-        
-        CFAllocatorDeallocate( alloc, item );
-        
-        theDict->_count--;
-        
-        break;
+        return;
     }
+    
+    CFDictionaryAssertMutable( theDict );
+    CFDictionaryAssertIntegerKeys( theDict );
+    CFDictionaryUnshare( theDict, true );
+    CFDictionaryRemove( theDict, ( const void * )( intptr_t )key, CFDictionaryHashInteger( key ) );
 }
 
 void CFDictionaryReplaceValue( CFMutableDictionaryRef theDict, const void * key, const void * value )
 {
-    struct CFDictionaryItem * item;
-    CFAllocatorRef            alloc;
+    struct CFDictionaryBucket * bucket;
+    CFAllocatorRef              alloc;
+    const void                * old;
     
     if( theDict == NULL )
     {
@@ -243,65 +221,132 @@ void CFDictionaryReplaceValue( CFMutableDictionaryRef theDict, const void * key,
     }
     
     CFDictionaryAssertMutable( theDict );
+    CFDictionaryUnshare( theDict, true );
     
-    item = CFDictionaryGetItem( theDict, key );
+    bucket = CFDictionaryGetBucket( theDict, key );
     
-    if( item == NULL )
+    if( bucket == NULL )
     {
         return;
     }
     
     alloc = CFGetAllocator( theDict );
-    
-    if( theDict->_valueCallbacks.release )
-    {
-        theDict->_valueCallbacks.release( alloc, item->value );
-    }
+    old   = bucket->value;
     
     if( theDict->_valueCallbacks.retain )
     {
-        item->value = theDict->_valueCallbacks.retain( alloc, value );
+        bucket->value = theDict->_valueCallbacks.retain( alloc, value );
     }
     else
     {
-        item->value = value;
+        bucket->value = value;
+    }
+    
+    CFDictionaryUnindexValue( theDict, old );
+    CFDictionaryIndexValue( theDict, bucket->value );
+    
+    if( theDict->_valueCallbacks.release )
+    {
+        theDict->_valueCallbacks.release( alloc, old );
     }
 }
 
 void CFDictionarySetValue( CFMutableDictionaryRef theDict, const void * key, const void * value )
 {
-    struct CFDictionaryItem * item;
-    CFAllocatorRef            alloc;
+    if( theDict == NULL )
+    {
+        return;
+    }
     
+    CFDictionaryAssertMutable( theDict );
+    CFDictionaryUnshare( theDict, true );
+    CFDictionaryInsert( theDict, key, value );
+}
+
+void CFDictionarySetValueForIntegerKey( CFMutableDictionaryRef theDict, SInt64 key, const void * value )
+{
     if( theDict == NULL )
     {
         return;
     }
     
     CFDictionaryAssertMutable( theDict );
+    CFDictionaryAssertIntegerKeys( theDict );
+    CFDictionaryUnshare( theDict, true );
+    CFDictionaryInsertWithHash( theDict, ( const void * )( intptr_t )key, value, CFDictionaryHashInteger( key ) );
+}
+
+void CFDictionarySetIncrementalResizeEnabled( CFMutableDictionaryRef theDict, Boolean enabled )
+{
+    if( theDict == NULL )
+    {
+        return;
+    }
     
-    item = CFDictionaryGetItem( theDict, key );
+    CFDictionaryAssertMutable( theDict );
     
-    if( item == NULL )
+    theDict->_incremental = enabled;
+    
+    if( enabled == false )
+    {
+        CFDictionaryMigrate( theDict, -1 );
+    }
+}
+
+Boolean CFDictionarySetValueIndexEnabled( CFMutableDictionaryRef theDict, Boolean enabled )
+{
+    if( theDict == NULL )
+    {
+        return false;
+    }
+    
+    CFDictionaryAssertMutable( theDict );
+    
+    if( enabled == false )
     {
-        CFDictionaryInsert( theDict, key, value, true );
+        if( theDict->_valueIndex )
+        {
+            CFRelease( theDict->_valueIndex );
+        }
         
-        return;
+        theDict->_valueIndex = NULL;
+        
+        return true;
     }
     
-    alloc = CFGetAllocator( theDict );
+    if( theDict->_valueIndex )
+    {
+        return true;
+    }
     
-    if( theDict->_valueCallbacks.release )
+    return CFDictionaryCreateValueIndex( theDict );
+}
+
+void CFDictionaryReserveCapacity( CFMutableDictionaryRef theDict, CFIndex capacity )
+{
+    if( theDict == NULL )
     {
-        theDict->_valueCallbacks.release( alloc, item->value );
+        return;
     }
     
-    if( theDict->_valueCallbacks.retain )
+    CFDictionaryAssertMutable( theDict );
+    CFDictionaryUnshare( theDict, true );
+    CFDictionaryReserve( theDict, capacity );
+}
+
+void CFDictionaryCompact( CFMutableDictionaryRef theDict )
+{
+    if( theDict == NULL )
     {
-        item->value = theDict->_valueCallbacks.retain( alloc, value );
+        return;
     }
-    else
+    
+    CFDictionaryAssertMutable( theDict );
+    CFDictionaryUnshare( theDict, true );
+    
+    /* Rehashes even at the same capacity, to purge deleted buckets */
+    if( CFDictionaryResize( theDict, CFDictionaryCapacityForCount( theDict->_count ) ) )
     {
-        item->value = value;
+        CFDictionaryMigrate( theDict, -1 );
     }
 }
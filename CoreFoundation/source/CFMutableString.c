@@ -30,6 +30,7 @@
 #include <CoreFoundation/CoreFoundation.h>
 #include <CoreFoundation/__private/__CFString.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <ctype.h>
 
@@ -123,55 +124,19 @@ CFMutableStringRef CFStringCreateMutableWithExternalCharactersNoCopy( CFAllocato
 
 void CFStringAppend( CFMutableStringRef theString, CFStringRef appendedString )
 {
-    char  * buf;
-    CFIndex size;
-    CFIndex capacity;
-    char  * cStr;
-    
-    if( theString == NULL || appendedString == NULL )
+    if( theString == NULL || appendedString == NULL || appendedString->_cStr == NULL )
     {
         return;
     }
     
     CFStringAssertMutable( theString );
     
-    size = CFStringGetMaximumSizeForEncoding( appendedString->_length + 1, theString->_encoding );
-    buf  = CFAllocatorAllocate( NULL, size, 0 );
-    
-    if( buf == NULL )
+    if( appendedString->_encoding != theString->_encoding )
     {
         return;
     }
     
-    if( CFStringGetCString( appendedString, buf, size, theString->_encoding ) == false )
-    {
-        CFAllocatorDeallocate( NULL, buf );
-        
-        return;
-    }
-    
-    capacity = theString->_length + size;
-    
-    if( capacity > theString->_capacity )
-    {
-        cStr = CFAllocatorReallocate( theString->_allocator, theString->_cStr, capacity, 0 );
-        
-        if( cStr == NULL )
-        {
-            CFAllocatorDeallocate( NULL, buf );
-            
-            return;
-        }
-        
-        theString->_cStr     = cStr;
-        theString->_capacity = capacity;
-    }
-    
-    strcat( theString->_cStr, buf );
-    
-    theString->_length = theString->_length + appendedString->_length;
-    
-    CFAllocatorDeallocate( NULL, buf );
+    CFStringAppendBytes( theString, appendedString->_cStr, appendedString->_length );
 }
 
 void CFStringAppendCharacters( CFMutableStringRef theString, const UniChar * chars, CFIndex numChars )
@@ -196,8 +161,6 @@ void CFStringAppendCharacters( CFMutableStringRef theString, const UniChar * cha
 
 void CFStringAppendCString( CFMutableStringRef theString, const char * cStr, CFStringEncoding encoding )
 {
-    CFStringRef s;
-    
     if( theString == NULL || cStr == NULL )
     {
         return;
@@ -205,13 +168,12 @@ void CFStringAppendCString( CFMutableStringRef theString, const char * cStr, CFS
     
     CFStringAssertMutable( theString );
     
-    s = CFStringCreateWithCString( NULL, cStr, encoding );
-    
-    if( s )
+    if( encoding != theString->_encoding )
     {
-        CFStringAppend( theString, s );
-        CFRelease( s );
+        return;
     }
+    
+    CFStringAppendBytes( theString, cStr, ( CFIndex )strlen( cStr ) );
 }
 
 void CFStringAppendFormat( CFMutableStringRef theString, CFDictionaryRef formatOptions, CFStringRef format, ... )
@@ -232,22 +194,59 @@ void CFStringAppendFormat( CFMutableStringRef theString, CFDictionaryRef formatO
 
 void CFStringAppendFormatAndArguments( CFMutableStringRef theString, CFDictionaryRef formatOptions, CFStringRef format, va_list arguments )
 {
-    CFStringRef s;
+    char    buf[ CF_STRING_FORMAT_BUFFER ];
+    char  * str;
+    va_list ap;
+    int     length;
     
-    if( theString == NULL || format == NULL )
+    ( void )formatOptions;
+    
+    if( theString == NULL || format == NULL || format->_cStr == NULL )
     {
         return;
     }
     
     CFStringAssertMutable( theString );
     
-    s = CFStringCreateWithFormatAndArguments( NULL, formatOptions, format, arguments );
+    if( format->_encoding != kCFStringEncodingASCII )
+    {
+        return;
+    }
     
-    if( s )
+    /*
+     * Arguments may point into theString, so output is not written in place
+     * but into a stack buffer, or into a temporary one when it does not fit.
+     */
+    va_copy( ap, arguments );
+    
+    length = vsnprintf( buf, sizeof( buf ), format->_cStr, ap );
+    
+    va_end( ap );
+    
+    if( length <= 0 )
     {
-        CFStringAppend( theString, s );
-        CFRelease( s );
+        return;
+    }
+    
+    if( ( size_t )length < sizeof( buf ) )
+    {
+        CFStringAppendBytes( theString, buf, length );
+        
+        return;
     }
+    
+    str = CFAllocatorAllocate( NULL, length + 1, 0 );
+    
+    if( str == NULL )
+    {
+        CFRuntimeAbortWithOutOfMemoryError();
+        
+        return;
+    }
+    
+    vsnprintf( str, ( size_t )length + 1, format->_cStr, arguments );
+    CFStringAppendBytes( theString, str, length );
+    CFAllocatorDeallocate( NULL, str );
 }
 
 void CFStringAppendPascalString( CFMutableStringRef theString, ConstStr255Param pStr, CFStringEncoding encoding )
@@ -354,6 +353,8 @@ void CFStringLowercase( CFMutableStringRef theString, CFLocaleRef locale )
     {
         theString->_cStr[ i ] = ( char )tolower( theString->_cStr[ i ] );
     }
+    
+    theString->_hashed = false;
 }
 
 void CFStringNormalize( CFMutableStringRef theString, CFStringNormalizationForm theForm )
@@ -477,4 +478,6 @@ void CFStringUppercase( CFMutableStringRef theString, CFLocaleRef locale )
     {
         theString->_cStr[ i ] = ( char )toupper( theString->_cStr[ i ] );
     }
+    
+    theString->_hashed = false;
 }
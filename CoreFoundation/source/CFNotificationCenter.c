@@ -38,57 +38,21 @@ CFTypeID CFNotificationCenterGetTypeID( void )
 
 CFNotificationCenterRef CFNotificationCenterGetDarwinNotifyCenter( void )
 {
-    CFSpinLockLock( &CFNotificationCenterDarwinLock );
-    
-    if( CFNotificationCenterDarwin == NULL )
-    {
-        CFNotificationCenterDarwin = CFNotificationCenterCreate( NULL );
-        
-        if( CFNotificationCenterDarwin )
-        {
-            CFRuntimeSetObjectAsConstant( CFNotificationCenterDarwin );
-        }
-    }
-    
-    CFSpinLockUnlock( &CFNotificationCenterDarwinLock );
+    CFOnce( &CFNotificationCenterDarwinOnce, CFNotificationCenterCreateDarwin );
     
     return CFNotificationCenterDarwin;
 }
 
 CFNotificationCenterRef CFNotificationCenterGetDistributedCenter( void )
 {
-    CFSpinLockLock( &CFNotificationCenterDistributedLock );
-    
-    if( CFNotificationCenterDistributed == NULL )
-    {
-        CFNotificationCenterDistributed = CFNotificationCenterCreate( NULL );
-        
-        if( CFNotificationCenterDistributed )
-        {
-            CFRuntimeSetObjectAsConstant( CFNotificationCenterDistributed );
-        }
-    }
-    
-    CFSpinLockUnlock( &CFNotificationCenterDistributedLock );
+    CFOnce( &CFNotificationCenterDistributedOnce, CFNotificationCenterCreateDistributed );
     
     return CFNotificationCenterDistributed;
 }
 
 CFNotificationCenterRef CFNotificationCenterGetLocalCenter( void )
 {
-    CFSpinLockLock( &CFNotificationCenterLocalLock );
-    
-    if( CFNotificationCenterLocal == NULL )
-    {
-        CFNotificationCenterLocal = CFNotificationCenterCreate( NULL );
-        
-        if( CFNotificationCenterLocal )
-        {
-            CFRuntimeSetObjectAsConstant( CFNotificationCenterLocal );
-        }
-    }
-    
-    CFSpinLockUnlock( &CFNotificationCenterLocalLock );
+    CFOnce( &CFNotificationCenterLocalOnce, CFNotificationCenterCreateLocal );
     
     return CFNotificationCenterLocal;
 }
@@ -0,0 +1,332 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CFPersistentDictionary.c
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <CoreFoundation/__private/__CFPersistentDictionary.h>
+#include <CoreFoundation/__private/__CFDictionary.h>
+#include <CoreFoundation/__private/__CFRuntime.h>
+
+CFTypeID CFPersistentDictionaryGetTypeID( void )
+{
+    return CFPersistentDictionaryTypeID;
+}
+
+CFPersistentDictionaryRef CFPersistentDictionaryCreate( CFAllocatorRef allocator, const void ** keys, const void ** values, CFIndex numValues, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks )
+{
+    struct CFPersistentDictionary      * o;
+    struct CFPersistentDictionaryEntry * entries;
+    CFIndex                              i;
+    bool                                 success;
+    
+    o = CFPersistentDictionaryCreateEmpty( allocator, keyCallBacks, valueCallBacks );
+    
+    if( o == NULL || numValues <= 0 )
+    {
+        return o;
+    }
+    
+    /* Entries, followed by the scratch space for building */
+    entries = CFAllocatorAllocate( CFGetAllocator( o ), 2 * numValues * ( CFIndex )sizeof( struct CFPersistentDictionaryEntry ), 0 );
+    
+    if( entries == NULL )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    for( i = 0; i < numValues; i++ )
+    {
+        entries[ i ].key   = keys[ i ];
+        entries[ i ].value = values[ i ];
+        entries[ i ].hash  = CFPersistentDictionaryHashKey( o, keys[ i ] );
+    }
+    
+    success = CFPersistentDictionaryNodeBuild( o, entries, entries + numValues, numValues, 0, &( o->_root ), &( o->_count ) );
+    
+    CFAllocatorDeallocate( CFGetAllocator( o ), entries );
+    
+    if( success == false )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    return o;
+}
+
+CFPersistentDictionaryRef CFPersistentDictionaryCreateWithDictionary( CFAllocatorRef allocator, CFDictionaryRef theDict )
+{
+    struct CFPersistentDictionary      * o;
+    struct CFPersistentDictionaryEntry * entries;
+    struct CFDictionaryBucket          * bucket;
+    CFIndex                              i;
+    CFIndex                              n;
+    bool                                 success;
+    
+    if( theDict == NULL )
+    {
+        return NULL;
+    }
+    
+    o = CFPersistentDictionaryCreateEmpty( allocator, &( theDict->_keyCallbacks ), &( theDict->_valueCallbacks ) );
+    
+    if( o == NULL || theDict->_count == 0 )
+    {
+        return o;
+    }
+    
+    entries = CFAllocatorAllocate( CFGetAllocator( o ), 2 * theDict->_count * ( CFIndex )sizeof( struct CFPersistentDictionaryEntry ), 0 );
+    
+    if( entries == NULL )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    i = 0;
+    n = 0;
+    
+    /* The hashes cached by the dictionary are mixed the same way */
+    while( ( bucket = CFDictionaryNextBucket( theDict, &i ) ) )
+    {
+        entries[ n ].key   = bucket->key;
+        entries[ n ].value = bucket->value;
+        entries[ n ].hash  = bucket->hash;
+        n++;
+    }
+    
+    success = CFPersistentDictionaryNodeBuild( o, entries, entries + n, n, 0, &( o->_root ), &( o->_count ) );
+    
+    CFAllocatorDeallocate( CFGetAllocator( o ), entries );
+    
+    if( success == false )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    return o;
+}
+
+CFDictionaryRef CFPersistentDictionaryCreateDictionary( CFAllocatorRef allocator, CFPersistentDictionaryRef theDict )
+{
+    struct CFDictionary       * o;
+    struct CFDictionaryBucket * buckets;
+    CFIndex                     n;
+    bool                        success;
+    
+    if( theDict == NULL )
+    {
+        return NULL;
+    }
+    
+    o = ( struct CFDictionary * )CFDictionaryCreate( allocator, NULL, NULL, 0, &( theDict->_keyCallbacks ), &( theDict->_valueCallbacks ) );
+    
+    if( o == NULL || theDict->_count == 0 )
+    {
+        return o;
+    }
+    
+    buckets = CFAllocatorAllocate( CFGetAllocator( o ), theDict->_count * ( CFIndex )sizeof( struct CFDictionaryBucket ), 0 );
+    
+    if( buckets == NULL )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    n = 0;
+    
+    /* Entries have the layout of dictionary buckets, with the same hashes */
+    CFPersistentDictionaryNodeGetEntries( theDict->_root, ( struct CFPersistentDictionaryEntry * )( ( void * )buckets ), &n );
+    
+    success = CFDictionaryReserve( o, n ) && CFDictionaryInsertBuckets( o, buckets, n, true );
+    
+    CFAllocatorDeallocate( CFGetAllocator( o ), buckets );
+    
+    if( success == false )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    return o;
+}
+
+CFPersistentDictionaryRef CFPersistentDictionaryCreateBySettingValue( CFPersistentDictionaryRef theDict, const void * key, const void * value )
+{
+    struct CFPersistentDictionary     * o;
+    struct CFPersistentDictionaryNode * root;
+    struct CFPersistentDictionaryEntry  entry;
+    bool                                added;
+    
+    if( theDict == NULL )
+    {
+        return NULL;
+    }
+    
+    entry.key   = key;
+    entry.value = value;
+    entry.hash  = CFPersistentDictionaryHashKey( theDict, key );
+    
+    if( CFPersistentDictionaryNodeSet( theDict, theDict->_root, 0, &entry, &root, &added ) == false )
+    {
+        return NULL;
+    }
+    
+    if( root == theDict->_root )
+    {
+        CFPersistentDictionaryNodeRelease( theDict, root );
+        
+        return CFRetain( theDict );
+    }
+    
+    o = CFPersistentDictionaryCreateEmpty( CFGetAllocator( theDict ), &( theDict->_keyCallbacks ), &( theDict->_valueCallbacks ) );
+    
+    if( o == NULL )
+    {
+        CFPersistentDictionaryNodeRelease( theDict, root );
+        
+        return NULL;
+    }
+    
+    o->_root  = root;
+    o->_count = ( added ) ? theDict->_count + 1 : theDict->_count;
+    
+    return o;
+}
+
+CFPersistentDictionaryRef CFPersistentDictionaryCreateByRemovingValue( CFPersistentDictionaryRef theDict, const void * key )
+{
+    struct CFPersistentDictionary     * o;
+    struct CFPersistentDictionaryNode * root;
+    
+    if( theDict == NULL )
+    {
+        return NULL;
+    }
+    
+    if( CFPersistentDictionaryNodeRemove( theDict, theDict->_root, 0, key, CFPersistentDictionaryHashKey( theDict, key ), &root ) == false )
+    {
+        return NULL;
+    }
+    
+    if( root == theDict->_root )
+    {
+        CFPersistentDictionaryNodeRelease( theDict, root );
+        
+        return CFRetain( theDict );
+    }
+    
+    o = CFPersistentDictionaryCreateEmpty( CFGetAllocator( theDict ), &( theDict->_keyCallbacks ), &( theDict->_valueCallbacks ) );
+    
+    if( o == NULL )
+    {
+        CFPersistentDictionaryNodeRelease( theDict, root );
+        
+        return NULL;
+    }
+    
+    o->_root  = root;
+    o->_count = theDict->_count - 1;
+    
+    return o;
+}
+
+CFIndex CFPersistentDictionaryGetCount( CFPersistentDictionaryRef theDict )
+{
+    if( theDict == NULL )
+    {
+        return 0;
+    }
+    
+    return theDict->_count;
+}
+
+Boolean CFPersistentDictionaryContainsKey( CFPersistentDictionaryRef theDict, const void * key )
+{
+    if( theDict == NULL )
+    {
+        return false;
+    }
+    
+    return CFPersistentDictionaryNodeFind( theDict, theDict->_root, key, CFPersistentDictionaryHashKey( theDict, key ) ) != NULL;
+}
+
+const void * CFPersistentDictionaryGetValue( CFPersistentDictionaryRef theDict, const void * key )
+{
+    const void * value;
+    
+    if( CFPersistentDictionaryGetValueIfPresent( theDict, key, &value ) )
+    {
+        return value;
+    }
+    
+    return NULL;
+}
+
+Boolean CFPersistentDictionaryGetValueIfPresent( CFPersistentDictionaryRef theDict, const void * key, const void ** value )
+{
+    struct CFPersistentDictionaryEntry * entry;
+    
+    if( theDict == NULL || theDict->_root == NULL )
+    {
+        return false;
+    }
+    
+    entry = CFPersistentDictionaryNodeFind( theDict, theDict->_root, key, CFPersistentDictionaryHashKey( theDict, key ) );
+    
+    if( entry == NULL )
+    {
+        return false;
+    }
+    
+    if( value )
+    {
+        *( value ) = entry->value;
+    }
+    
+    return true;
+}
+
+void CFPersistentDictionaryApplyFunction( CFPersistentDictionaryRef theDict, CFDictionaryApplierFunction applier, void * context )
+{
+    if( theDict == NULL || applier == NULL )
+    {
+        return;
+    }
+    
+    CFPersistentDictionaryNodeApply( theDict->_root, applier, context );
+}
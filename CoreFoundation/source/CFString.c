@@ -40,82 +40,73 @@ CFTypeID CFStringGetTypeID( void )
 
 CF_EXPORT CFStringRef CFStringMakeConstantString( const char * cp )
 {
-    CFIndex     i;
-    CFStringRef s;
+    struct CFString key;
+    CFStringRef     s;
+    CFStringRef     u;
     
     if( cp == NULL )
     {
         return NULL;
     }
     
-    CFSpinLockLock( &CFStringConstantStringsLock );
+    u = CFStringGetUniqued( CFStringInitConstant( &key, cp, ( CFIndex )strlen( cp ) ) );
     
-    if( CFStringConstantStrings == NULL )
+    if( u != NULL )
     {
-        CFStringConstantStrings = calloc( sizeof( CFStringRef ), 1024 );
-        
-        if( CFStringConstantStrings == NULL )
-        {
-            CFSpinLockUnlock( &CFStringConstantStringsLock );
-            CFRuntimeAbortWithOutOfMemoryError();
-            
-            return NULL;
-        }
+        return u;
+    }
+    
+    s = CFStringCreateWithCStringNoCopy( NULL, cp, kCFStringEncodingASCII, kCFAllocatorNull );
+    
+    if( s == NULL )
+    {
+        CFRuntimeAbortWithOutOfMemoryError();
         
-        CFStringConstantStringsCapacity = 1024;
+        return NULL;
     }
     
-    for( i = 0; i < CFStringConstantStringsCapacity; i++ )
+    u = CFStringAddUniqued( s );
+    
+    if( u != s )
     {
-        if( CFStringConstantStrings[ i ] != NULL && CFStringConstantStrings[ i ]->_cStr == cp )
-        {
-            CFSpinLockUnlock( &CFStringConstantStringsLock );
-            
-            return CFStringConstantStrings[ i ];
-        }
+        CFRelease( s );
     }
     
-    s = CFStringCreateWithCStringNoCopy( NULL, cp, kCFStringEncodingASCII, kCFAllocatorNull );
+    return u;
+}
+
+CFStringRef CFStringCreateUniqued( CFAllocatorRef alloc, CFStringRef theString )
+{
+    CFStringRef s;
+    CFStringRef u;
+    
+    if( theString == NULL || theString->_cStr == NULL )
+    {
+        return NULL;
+    }
+    
+    u = CFStringGetUniqued( theString );
+    
+    if( u != NULL )
+    {
+        return u;
+    }
+    
+    s = CFStringCreateWithCString( alloc, theString->_cStr, theString->_encoding );
     
     if( s == NULL )
     {
-        CFSpinLockUnlock( &CFStringConstantStringsLock );
-        CFRuntimeAbortWithOutOfMemoryError();
-        
         return NULL;
     }
     
-    CFRuntimeSetObjectAsConstant( s );
+    u = CFStringAddUniqued( s );
     
-    add:
-        
-        for( i = 0; i < CFStringConstantStringsCapacity; i++ )
-        {
-            if( CFStringConstantStrings[ i ] == NULL )
-            {
-                CFStringConstantStrings[ i ] = s;
-                
-                CFSpinLockUnlock( &CFStringConstantStringsLock );
-                
-                return s;
-            }
-        }
-        
-        CFStringConstantStrings = realloc( ( void * )CFStringConstantStrings, 2 * ( size_t )CFStringConstantStringsCapacity * sizeof( CFStringRef ) );
-        
-        if( CFStringConstantStrings == NULL )
-        {
-            CFSpinLockUnlock( &CFStringConstantStringsLock );
-            CFRuntimeAbortWithOutOfMemoryError();
-            
-            return NULL;
-        }
-        
-        memset( ( void * )( CFStringConstantStrings + CFStringConstantStringsCapacity ), 0, ( size_t )CFStringConstantStringsCapacity );
-        
-        CFStringConstantStringsCapacity *= 2;
-        
-        goto add;
+    if( u != s )
+    {
+        CFRelease( s );
+    }
+    
+    return u;
 }
 
 CFArrayRef CFStringCreateArrayBySeparatingStrings( CFAllocatorRef alloc, CFStringRef theString, CFStringRef separatorString )
@@ -200,36 +191,34 @@ CFStringRef CFStringCreateWithCharactersNoCopy( CFAllocatorRef alloc, const UniC
 CFStringRef CFStringCreateWithCString( CFAllocatorRef alloc, const char * cStr, CFStringEncoding encoding )
 {
     struct CFString * o;
-    char            * buf;
+    CFIndex           length;
     
     if( cStr == NULL )
     {
         return NULL;
     }
     
-    o = ( struct CFString * )CFRuntimeCreateInstance( alloc, CFStringTypeID );
+    length = ( CFIndex )strlen( cStr );
+    o      = ( struct CFString * )CFRuntimeCreateInstanceWithExtraBytes( alloc, CFStringTypeID, length + 1 );
     
-    if( o )
+    if( o == NULL )
     {
-        o->_allocator   = ( alloc ) ? CFRetain( alloc ) : NULL;
-        o->_length      = ( CFIndex )strlen( cStr );
-        o->_capacity    = o->_length;
-        o->_encoding    = encoding;
-        buf             = CFAllocatorAllocate( alloc, o->_length + 1, 0 );
-        
-        if( buf == NULL )
-        {
-            CFRelease( o );
-            CFRuntimeAbortWithOutOfMemoryError();
-            
-            return NULL;
-        }
-        
-        memcpy( buf, cStr, ( size_t )( o->_length + 1 ) );
+        CFRuntimeAbortWithOutOfMemoryError();
         
-        o->_cStr = buf;
+        return NULL;
     }
     
+    /* Immutable, so the bytes are stored in the object allocation itself */
+    o->_cStr        = CF_STRING_INLINE_BYTES( o );
+    o->_length      = length;
+    o->_capacity    = length;
+    o->_encoding    = encoding;
+    
+    memcpy( o->_cStr, cStr, ( size_t )( length + 1 ) );
+    
+    o->_hash        = CFStringHashBytes( o->_cStr, length );
+    o->_hashed      = true;
+    
     return ( CFStringRef )o;
 }
 
@@ -251,6 +240,8 @@ CFStringRef CFStringCreateWithCStringNoCopy( CFAllocatorRef alloc, const char *
         o->_length      = ( CFIndex )strlen( cStr );
         o->_capacity    = o->_length;
         o->_allocator   = ( contentsDeallocator ) ? CFRetain( contentsDeallocator ) : NULL;
+        o->_hash        = CFStringHashBytes( cStr, o->_length );
+        o->_hashed      = true;
     }
     
     return ( CFStringRef )o;
@@ -28,5 +28,93 @@
  */
 
 #include <CoreFoundation/CoreFoundation.h>
+#include <CoreFoundation/__private/__CFString.h>
+#include <CoreFoundation/__private/__CFSpinLock.h>
+#include <CoreFoundation/__private/__CFAtomic.h>
 
+CF_STRING_CONST_DECL( kCFLockStatisticsAcquisitionsKey,          "Acquisitions" );
+CF_STRING_CONST_DECL( kCFLockStatisticsContendedAcquisitionsKey, "ContendedAcquisitions" );
+CF_STRING_CONST_DECL( kCFLockStatisticsWaitTimeKey,              "WaitTime" );
+CF_STRING_CONST_DECL( kCFLockStatisticsMaxHoldTimeKey,           "MaxHoldTime" );
 
+void CFLockSetProfilingEnabled( Boolean enabled )
+{
+    CFAtomicStoreRelease( ( enabled ) ? 1 : 0, &CFSpinLockProfiling );
+}
+
+Boolean CFLockIsProfilingEnabled( void )
+{
+    return CFAtomicLoadAcquire( &CFSpinLockProfiling ) != 0;
+}
+
+CFDictionaryRef CFLockCopyStatistics( void )
+{
+    CFMutableDictionaryRef  all;
+    CFMutableDictionaryRef  info;
+    CFStringRef             name;
+    CFNumberRef             n;
+    CFSpinLockStatistics  * statistics;
+    int64_t                 values[ 4 ];
+    int64_t                 value;
+    CFStringRef             keys[ 4 ];
+    int                     i;
+    
+    all = CFDictionaryCreateMutable( NULL, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks );
+    
+    if( all == NULL )
+    {
+        return NULL;
+    }
+    
+    keys[ 0 ] = kCFLockStatisticsAcquisitionsKey;
+    keys[ 1 ] = kCFLockStatisticsContendedAcquisitionsKey;
+    keys[ 2 ] = kCFLockStatisticsWaitTimeKey;
+    keys[ 3 ] = kCFLockStatisticsMaxHoldTimeKey;
+    
+    for( statistics = CFSpinLockStatisticsList; statistics != NULL; statistics = statistics->next )
+    {
+        values[ 0 ] = statistics->acquisitions;
+        values[ 1 ] = statistics->contendedAcquisitions;
+        values[ 2 ] = statistics->waitTime;
+        values[ 3 ] = statistics->maxHoldTime;
+        
+        name = CFStringCreateWithCString( NULL, statistics->name, kCFStringEncodingASCII );
+        info = CFDictionaryCreateMutable( NULL, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks );
+        
+        if( name == NULL || info == NULL )
+        {
+            CFRelease( name );
+            CFRelease( info );
+            
+            continue;
+        }
+        
+        for( i = 0; i < 4; i++ )
+        {
+            value = values[ i ];
+            n     = CFNumberCreate( NULL, kCFNumberSInt64Type, &value );
+            
+            CFDictionarySetValue( info, keys[ i ], n );
+            CFRelease( n );
+        }
+        
+        CFDictionarySetValue( all, name, info );
+        CFRelease( name );
+        CFRelease( info );
+    }
+    
+    return all;
+}
+
+void CFLockResetStatistics( void )
+{
+    CFSpinLockStatistics * statistics;
+    
+    for( statistics = CFSpinLockStatisticsList; statistics != NULL; statistics = statistics->next )
+    {
+        statistics->acquisitions          = 0;
+        statistics->contendedAcquisitions = 0;
+        statistics->waitTime              = 0;
+        statistics->maxHoldTime           = 0;
+    }
+}
@@ -61,6 +61,8 @@ const CFAllocatorRef kCFAllocatorUseContext     = ( const CFAllocatorRef )( -1 )
 
 CFThreadingKey CFAllocatorDefaultKey;
 
+CFSpinLockStatistics CFAllocatorRegistryLockStatistics = CF_SPIN_LOCK_STATISTICS_INIT( "CFAllocator registry" );
+
 void CFAllocatorInitialize( void )
 {
     CFThreadingKeyCreate( &CFAllocatorDefaultKey );
@@ -94,18 +96,16 @@ void CFAllocatorInitialize( void )
 
 void CFAllocatorConstruct( CFAllocatorRef allocator )
 {
-    #if defined( CF_ALLOCATOR_DEBUG ) && CF_ALLOCATOR_DEBUG == 1
-    
     struct CFAllocator * a;
     
     a = ( struct CFAllocator * )allocator;
     
-    a->_registry     = calloc( sizeof( CFAllocatorRegistry ), 1024 );
-    a->_registrySize = 1024;
+    a->_registryLock.statistics = &CFAllocatorRegistryLockStatistics;
     
-    #else
+    #if defined( CF_ALLOCATOR_DEBUG ) && CF_ALLOCATOR_DEBUG == 1
     
-    ( void )allocator;
+    a->_registry     = calloc( sizeof( CFAllocatorRegistry ), 1024 );
+    a->_registrySize = 1024;
     
     #endif
 }
@@ -226,19 +226,21 @@ void CFAllocatorDebugRegisterAlloc( CFAllocatorRef allocator, const void * ptr,
             }
         }
         
-        a->_registry = realloc( a->_registry, 2 * ( size_t )( a->_registrySize ) * sizeof( void * ) );
-        
-        memset( a->_registry + a->_registrySize, 0, ( size_t )( a->_registrySize ) );
-        
-        a->_registrySize *= 2;
+        a->_registry = realloc( a->_registry, 2 * ( size_t )( a->_registrySize ) * sizeof( CFAllocatorRegistry ) );
         
         if( a->_registry == NULL )
         {
+            a->_registrySize = 0;
+            
             CFSpinLockUnlock( &( a->_registryLock ) );
             
             return;
         }
         
+        memset( a->_registry + a->_registrySize, 0, ( size_t )( a->_registrySize ) * sizeof( CFAllocatorRegistry ) );
+        
+        a->_registrySize *= 2;
+        
         goto add;
 }
 
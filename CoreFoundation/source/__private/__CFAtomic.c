@@ -167,6 +167,30 @@ int64_t CFAtomicDecrement64( volatile int64_t * value )
     #endif
 }
 
+int64_t CFAtomicAdd64( int64_t amount, volatile int64_t * value )
+{
+    #if defined( _WIN32 )
+    
+    return InterlockedAdd64( ( volatile LONGLONG * )value, amount );
+    
+    #elif defined( __APPLE__ )
+    
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    return OSAtomicAdd64( amount, value );
+    #pragma clang diagnostic pop
+    
+    #elif defined( __has_builtin ) && __has_builtin( __sync_add_and_fetch )
+    
+    return __sync_add_and_fetch( value, amount );
+    
+    #else
+    
+    #error "CFAtomicAdd64 is not implemented for the current platform"
+    
+    #endif
+}
+
 bool CFAtomicCompareAndSwap( CFIndex oldValue, CFIndex newValue, volatile CFIndex * value )
 {
     if( sizeof( CFIndex ) == sizeof( int32_t ) )
@@ -255,3 +279,131 @@ bool CFAtomicCompareAndSwapPointer( void * oldValue, void * newValue, void * vol
     
     #endif
 }
+
+CFIndex CFAtomicLoadAcquire( volatile CFIndex * value )
+{
+    #if defined( _WIN32 )
+    
+    CFIndex v;
+    
+    v = *( value );
+    
+    MemoryBarrier();
+    
+    return v;
+    
+    #elif defined( __has_builtin ) && __has_builtin( __atomic_load_n )
+    
+    return __atomic_load_n( value, __ATOMIC_ACQUIRE );
+    
+    #elif defined( __APPLE__ )
+    
+    CFIndex v;
+    
+    v = *( value );
+    
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    OSMemoryBarrier();
+    #pragma clang diagnostic pop
+    
+    return v;
+    
+    #else
+    
+    #error "CFAtomicLoadAcquire is not implemented for the current platform"
+    
+    #endif
+}
+
+void CFAtomicStoreRelease( CFIndex newValue, volatile CFIndex * value )
+{
+    #if defined( _WIN32 )
+    
+    MemoryBarrier();
+    
+    *( value ) = newValue;
+    
+    #elif defined( __has_builtin ) && __has_builtin( __atomic_store_n )
+    
+    __atomic_store_n( value, newValue, __ATOMIC_RELEASE );
+    
+    #elif defined( __APPLE__ )
+    
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    OSMemoryBarrier();
+    #pragma clang diagnostic pop
+    
+    *( value ) = newValue;
+    
+    #else
+    
+    #error "CFAtomicStoreRelease is not implemented for the current platform"
+    
+    #endif
+}
+
+void * CFAtomicLoadAcquirePointer( void * volatile * value )
+{
+    #if defined( _WIN32 )
+    
+    void * v;
+    
+    v = *( value );
+    
+    MemoryBarrier();
+    
+    return v;
+    
+    #elif defined( __has_builtin ) && __has_builtin( __atomic_load_n )
+    
+    return __atomic_load_n( value, __ATOMIC_ACQUIRE );
+    
+    #elif defined( __APPLE__ )
+    
+    void * v;
+    
+    v = *( value );
+    
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    OSMemoryBarrier();
+    #pragma clang diagnostic pop
+    
+    return v;
+    
+    #else
+    
+    #error "CFAtomicLoadAcquirePointer is not implemented for the current platform"
+    
+    #endif
+}
+
+void CFAtomicStoreReleasePointer( void * newValue, void * volatile * value )
+{
+    #if defined( _WIN32 )
+    
+    MemoryBarrier();
+    
+    *( value ) = newValue;
+    
+    #elif defined( __has_builtin ) && __has_builtin( __atomic_store_n )
+    
+    __atomic_store_n( value, newValue, __ATOMIC_RELEASE );
+    
+    #elif defined( __APPLE__ )
+    
+    #pragma clang diagnostic push
+    #pragma clang diagnostic ignored "-Wdeprecated-declarations"
+    OSMemoryBarrier();
+    #pragma clang diagnostic pop
+    
+    *( value ) = newValue;
+    
+    #else
+    
+    #error "CFAtomicStoreReleasePointer is not implemented for the current platform"
+    
+    #endif
+}
@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CFConcurrentDictionary.c
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <CoreFoundation/__private/__CFConcurrentDictionary.h>
+
+CFTypeID       CFConcurrentDictionaryTypeID = 0;
+CFRuntimeClass CFConcurrentDictionaryClass  =
+{
+    "CFConcurrentDictionary",
+    sizeof( struct CFConcurrentDictionary ),
+    NULL,
+    ( void ( * )( CFTypeRef ) )CFConcurrentDictionaryDestruct,
+    NULL,
+    NULL,
+    ( CFStringRef ( * )( CFTypeRef ) )CFConcurrentDictionaryCopyDescription
+};
+
+CFSpinLockStatistics CFConcurrentDictionaryLockStatistics = CF_SPIN_LOCK_STATISTICS_INIT( "CFConcurrentDictionary stripes" );
+
+void CFConcurrentDictionaryInitialize( void )
+{
+    CFConcurrentDictionaryTypeID = CFRuntimeRegisterClass( &CFConcurrentDictionaryClass );
+}
+
+void CFConcurrentDictionaryDestruct( CFConcurrentDictionaryRef d )
+{
+    CFIndex i;
+    
+    for( i = 0; i < CF_CONCURRENT_DICTIONARY_STRIPES; i++ )
+    {
+        if( d->_stripes[ i ].dictionary )
+        {
+            CFRelease( d->_stripes[ i ].dictionary );
+        }
+    }
+}
+
+CFStringRef CFConcurrentDictionaryCopyDescription( CFConcurrentDictionaryRef d )
+{
+    return CFStringCreateWithFormat
+    (
+        NULL,
+        NULL,
+        CFSTR( "{ count = %lu, stripes = %lu }" ),
+        CFConcurrentDictionaryGetCount( d ),
+        ( CFIndex )CF_CONCURRENT_DICTIONARY_STRIPES
+    );
+}
+
+struct CFConcurrentDictionaryStripe * CFConcurrentDictionaryLockStripe( CFConcurrentDictionaryRef d, const void * key, CFHashCode * h )
+{
+    struct CFConcurrentDictionaryStripe * stripe;
+    
+    /* Hashed before locking, as the stripe dictionaries would */
+    if( d->_keyCallbacks.hash )
+    {
+        *( h ) = CFDictionaryMixHash( d->_keyCallbacks.hash( key ) );
+    }
+    else
+    {
+        *( h ) = CFDictionaryMixHash( ( CFHashCode )( uintptr_t )key );
+    }
+    
+    stripe = &( d->_stripes[ CF_CONCURRENT_DICTIONARY_STRIPE( *( h ) ) ] );
+    
+    CFSpinLockLock( &( stripe->lock ) );
+    
+    return stripe;
+}
+
+void CFConcurrentDictionaryUnlockStripe( struct CFConcurrentDictionaryStripe * stripe )
+{
+    CFSpinLockUnlock( &( stripe->lock ) );
+}
+
+const void * CFConcurrentDictionaryRetainValue( CFConcurrentDictionaryRef d, const void * value )
+{
+    if( d->_valueCallbacks.retain )
+    {
+        return d->_valueCallbacks.retain( CFGetAllocator( d ), value );
+    }
+    
+    return value;
+}
+
+void CFConcurrentDictionaryReleaseValue( CFConcurrentDictionaryRef d, const void * value )
+{
+    if( d->_valueCallbacks.release )
+    {
+        d->_valueCallbacks.release( CFGetAllocator( d ), value );
+    }
+}
+
+void CFConcurrentDictionaryReleaseKey( CFConcurrentDictionaryRef d, const void * key )
+{
+    if( d->_keyCallbacks.release )
+    {
+        d->_keyCallbacks.release( CFGetAllocator( d ), key );
+    }
+}
@@ -28,6 +28,20 @@
  */
 
 #include <CoreFoundation/__private/__CFDictionary.h>
+#include <CoreFoundation/__private/__CFAtomic.h>
+#include <CoreFoundation/__private/__CFData.h>
+#include <CoreFoundation/__private/__CFHash.h>
+#include <CoreFoundation/__private/__CFString.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined( _WIN32 )
+#include <intrin.h>
+#endif
+
+#if CF_DICTIONARY_SSE2
+#include <emmintrin.h>
+#endif
 
 CFTypeID       CFDictionaryTypeID = 0;
 CFRuntimeClass CFDictionaryClass  =
@@ -41,6 +55,9 @@ CFRuntimeClass CFDictionaryClass  =
     ( CFStringRef ( * )( CFTypeRef ) )CFDictionaryCopyDescription
 };
 
+volatile CFIndex CFDictionaryProfiling            = 0;
+volatile double  CFDictionaryProbeLengthThreshold = 0;
+
 void CFDictionaryInitialize( void )
 {
     CFDictionaryTypeID = CFRuntimeRegisterClass( &CFDictionaryClass );
@@ -48,57 +65,30 @@ void CFDictionaryInitialize( void )
 
 void CFDictionaryDestruct( CFDictionaryRef d )
 {
-    CFAllocatorRef            alloc;
-    struct CFDictionaryItem * item;
-    struct CFDictionaryItem * del;
-    CFIndex                   i;
-    
-    alloc =CFGetAllocator( d );
-    
-    if( d->_items == NULL )
+    if( d->_valueIndex )
     {
-        return;
+        CFRelease( d->_valueIndex );
     }
     
-    for( i = 0; i < d->_size; i++ )
+    if( d->_shared && CFAtomicDecrement( d->_shared ) > 0 )
     {
-        item = d->_items[ i ];
-        
-        while( item )
-        {
-            del  = item;
-            item = item->next;
-            
-            if( d->_keyCallbacks.release )
-            {
-                d->_keyCallbacks.release( alloc, del->key );
-            }
-            
-            if( d->_valueCallbacks.release )
-            {
-                d->_valueCallbacks.release( alloc, del->value );
-            }
-            
-            CFAllocatorDeallocate( alloc, del );
-        }
+        /* Still used by other dictionaries */
+        return;
     }
     
-    CFAllocatorDeallocate( alloc, d->_items );
+    CFDictionaryReleaseStorage( d );
 }
 
-#include <stdio.h>
-
 bool CFDictionaryEquals( CFDictionaryRef d1, CFDictionaryRef d2 )
 {
-    CFIndex                   i;
-    CFIndex                   j;
-    struct CFDictionaryItem * item1;
-    struct CFDictionaryItem * item2;
-    bool                      found;
+    CFIndex                     i;
+    struct CFDictionaryBucket * bucket1;
+    struct CFDictionaryBucket * bucket2;
+    bool                        sameHash;
     
-    if( d1->_items == NULL || d2->_items == NULL )
+    if( d1 == d2 )
     {
-        return false;
+        return true;
     }
     
     if( d1->_count != d2->_count )
@@ -106,63 +96,30 @@ bool CFDictionaryEquals( CFDictionaryRef d1, CFDictionaryRef d2 )
         return false;
     }
     
-    for( i = 0; i < d1->_size; i++ )
+    if( d1->_buckets != NULL && d1->_buckets == d2->_buckets && d1->_valueCallbacks.equal == d2->_valueCallbacks.equal )
+    {
+        /* Shared storage */
+        return true;
+    }
+    
+    /* With the same hash callback, the hashes cached by d1 are valid for d2 */
+    sameHash = d1->_keyCallbacks.hash == d2->_keyCallbacks.hash;
+    i        = 0;
+    
+    while( ( bucket1 = CFDictionaryNextBucket( d1, &i ) ) )
     {
-        item1 = d1->_items[ i ];
+        if( sameHash )
+        {
+            bucket2 = CFDictionaryFind( d2, bucket1->key, bucket1->hash );
+        }
+        else
+        {
+            bucket2 = CFDictionaryGetBucket( d2, bucket1->key );
+        }
         
-        while( item1 )
+        if( bucket2 == NULL || CFDictionaryValuesEqual( d1, bucket1->value, bucket2->value ) == false )
         {
-            found = false;
-            
-            for( j = 0; j < d2->_size; j++ )
-            {
-                item2 = d2->_items[ j ];
-                
-                while( item2 )
-                {
-                    if( d1->_keyCallbacks.equal == NULL && item1->key != item2->key )
-                    {
-                        item2 = item2->next;
-                        
-                        continue;
-                    }
-                    else if( item1->key != item2->key && d1->_keyCallbacks.equal( item1->key, item2->key ) == false )
-                    {
-                        item2 = item2->next;
-                        
-                        continue;
-                    }
-                    
-                    if( d1->_valueCallbacks.equal == NULL && item1->value != item2->value )
-                    {
-                        item2 = item2->next;
-                        
-                        continue;
-                    }
-                    else if( item1->value != item2->value && d1->_valueCallbacks.equal( item1->value, item2->value ) == false )
-                    {
-                        item2 = item2->next;
-                        
-                        continue;
-                    }
-                    
-                    found = true;
-                    
-                    break;
-                }
-                
-                if( found )
-                {
-                    break;
-                }
-            }
-            
-            if( found == false )
-            {
-                return false;
-            }
-            
-            item1 = item1->next;
+            return false;
         }
     }
     
@@ -171,11 +128,11 @@ bool CFDictionaryEquals( CFDictionaryRef d1, CFDictionaryRef d2 )
 
 CFStringRef CFDictionaryCopyDescription( CFDictionaryRef d )
 {
-    CFMutableStringRef        s;
-    CFIndex                   i;
-    struct CFDictionaryItem * item;
-    CFStringRef               k;
-    CFStringRef               v;
+    CFMutableStringRef          s;
+    CFIndex                     i;
+    struct CFDictionaryBucket * bucket;
+    CFStringRef                 k;
+    CFStringRef                 v;
     
     s = CFStringCreateMutable( NULL, 0 );
     
@@ -190,7 +147,7 @@ CFStringRef CFDictionaryCopyDescription( CFDictionaryRef d )
         NULL,
         CFSTR( "{ count = %lu, capacity = %lu, type = %s }" ),
         d->_count,
-        d->_size,
+        ( d->_buckets ) ? d->_capacity : CF_DICTIONARY_INLINE_CAPACITY,
         ( d->_mutable ) ? "mutable" : "immutable"
     );
     
@@ -201,55 +158,50 @@ CFStringRef CFDictionaryCopyDescription( CFDictionaryRef d )
     
     CFStringAppendCString( s, "\n{\n", kCFStringEncodingASCII );
     
-    for( i = 0; i < d->_size; i++ )
+    i = 0;
+    
+    while( ( bucket = CFDictionaryNextBucket( d, &i ) ) )
     {
-        item = d->_items[ i ];
+        k = NULL;
+        v = NULL;
         
-        while( item )
+        if( d->_keyCallbacks.copyDescription )
         {
-            k = NULL;
-            v = NULL;
-            
-            if( d->_keyCallbacks.copyDescription )
-            {
-                k = d->_keyCallbacks.copyDescription( item->key );
-            }
-            
-            if( d->_valueCallbacks.copyDescription )
-            {
-                v = d->_valueCallbacks.copyDescription( item->value );
-            }
-            
-            if( k == NULL )
-            {
-                k = CFStringCreateWithFormat( NULL, NULL, CFSTR( "0x%lu" ), item->key );
-            }
-            
-            if( v == NULL )
-            {
-                v = CFStringCreateWithFormat( NULL, NULL, CFSTR( "0x%lu" ), item->value );
-            }
-            
-            if( k && v )
-            {
-                CFStringAppendCString( s, "    ", kCFStringEncodingASCII );
-                CFStringAppend( s, k );
-                CFStringAppendCString( s, " = ", kCFStringEncodingASCII );
-                CFStringAppend( s, v );
-                CFStringAppendCString( s, "\n", kCFStringEncodingASCII );
-            }
-            
-            if( k )
-            {
-                CFRelease( k );
-            }
-            
-            if( v )
-            {
-                CFRelease( v );
-            }
-            
-            item = item->next;
+            k = d->_keyCallbacks.copyDescription( bucket->key );
+        }
+        
+        if( d->_valueCallbacks.copyDescription )
+        {
+            v = d->_valueCallbacks.copyDescription( bucket->value );
+        }
+        
+        if( k == NULL )
+        {
+            k = CFStringCreateWithFormat( NULL, NULL, CFSTR( "0x%lu" ), bucket->key );
+        }
+        
+        if( v == NULL )
+        {
+            v = CFStringCreateWithFormat( NULL, NULL, CFSTR( "0x%lu" ), bucket->value );
+        }
+        
+        if( k && v )
+        {
+            CFStringAppendCString( s, "    ", kCFStringEncodingASCII );
+            CFStringAppend( s, k );
+            CFStringAppendCString( s, " = ", kCFStringEncodingASCII );
+            CFStringAppend( s, v );
+            CFStringAppendCString( s, "\n", kCFStringEncodingASCII );
+        }
+        
+        if( k )
+        {
+            CFRelease( k );
+        }
+        
+        if( v )
+        {
+            CFRelease( v );
         }
     }
     
@@ -272,239 +224,1757 @@ void CFDictionaryCallbackRelease( CFAllocatorRef allocator, const void * value )
     CFRelease( value );
 }
 
-struct CFDictionaryItem * CFDictionaryGetItem( CFDictionaryRef d, const void * key )
+CFHashCode CFDictionaryCallbackSeededHash( const void * value )
 {
-    CFHashCode                h;
-    struct CFDictionaryItem * item;
+    CFTypeID   type;
+    CFHashCode h;
+    
+    type = CFGetTypeID( value );
     
-    if( d == NULL || d->_items == NULL )
+    if( type == CFStringGetTypeID() && ( ( CFStringRef )value )->_cStr != NULL )
     {
-        return false;
+        return CFHashSeeded( ( ( CFStringRef )value )->_cStr, ( ( CFStringRef )value )->_length );
+    }
+    
+    if( type == CFDataGetTypeID() && ( ( CFDataRef )value )->_bytes != NULL )
+    {
+        return CFHashSeeded( ( ( CFDataRef )value )->_bytes, ( ( CFDataRef )value )->_length );
+    }
+    
+    /*
+     * Other types keep their own hash, which only gets randomized: keys
+     * colliding under CFHash still collide.
+     */
+    h = CFHash( value );
+    
+    return CFHashSeeded( &h, sizeof( h ) );
+}
+
+CFHashCode CFDictionaryHashKey( CFDictionaryRef d, const void * key )
+{
+    CFHashCode h;
+    
+    if( CFDictionaryProfiling && d->_keyCallbacks.hash )
+    {
+        CFAtomicAdd64( 1, &( ( ( struct CFDictionary * )d )->_hashCalls ) );
     }
     
-    if( d->_keyCallbacks.hash )
+    if( d->_keyCallbacks.hash == CFHash && key != NULL && CF_STRING_IS_STRING( key ) )
+    {
+        /*
+         * Standard callbacks and a CFString key: hash it directly, rather
+         * than through CFHash and a class lookup. The result is the same.
+         */
+        h = CFStringHash( key );
+    }
+    else if( d->_keyCallbacks.hash )
     {
         h = d->_keyCallbacks.hash( key );
     }
     else
     {
-        h = ( uint64_t )key;
+        h = ( CFHashCode )( uintptr_t )key;
+    }
+    
+    return CFDictionaryMixHash( h );
+}
+
+CFHashCode CFDictionaryMixHash( CFHashCode h )
+{
+    /*
+     * MurmurHash3 64-bit finalizer. Every bit of the result depends on every
+     * bit of h, so pointers (with low bits cleared by alignment), small
+     * integers and hashes only differing in their high bits are spread over
+     * the whole table, both for H1 (low bits) and H2 (high bits).
+     */
+    h ^= h >> 33;
+    h *= ( CFHashCode )0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= ( CFHashCode )0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    
+    return h;
+}
+
+CFHashCode CFDictionaryHashInteger( SInt64 key )
+{
+    /*
+     * The mix is a bijection, so two integer keys are equal if and only if
+     * their hashes are. On hosts with 32-bit pointers, bucket keys are
+     * truncated, but the hash still tells them apart.
+     */
+    return CFDictionaryMixHash( ( CFHashCode )key );
+}
+
+bool CFDictionaryKeysEqual( CFDictionaryRef d, const void * key1, const void * key2 )
+{
+    if( key1 == key2 )
+    {
+        return true;
+    }
+    
+    if( CFDictionaryProfiling && d->_keyCallbacks.equal )
+    {
+        CFAtomicAdd64( 1, &( ( ( struct CFDictionary * )d )->_equalCalls ) );
+    }
+    
+    if
+    (
+           d->_keyCallbacks.equal == CFEqual
+        && key1 != NULL && CF_STRING_IS_STRING( key1 )
+        && key2 != NULL && CF_STRING_IS_STRING( key2 )
+    )
+    {
+        return CFStringEquals( key1, key2 );
+    }
+    
+    return d->_keyCallbacks.equal && d->_keyCallbacks.equal( key1, key2 );
+}
+
+bool CFDictionaryValuesEqual( CFDictionaryRef d, const void * value1, const void * value2 )
+{
+    if( value1 == value2 )
+    {
+        return true;
+    }
+    
+    return d->_valueCallbacks.equal && d->_valueCallbacks.equal( value1, value2 );
+}
+
+CFIndex CFDictionaryProbe( CFDictionaryRef d, const struct CFDictionaryBucket * buckets, const int8_t * controls, CFIndex capacity, const void * key, CFHashCode h )
+{
+    CFIndex               mask;
+    CFIndex               pos;
+    CFIndex               step;
+    CFIndex               slot;
+    int8_t                h2;
+    CFDictionaryGroupMask match;
+    
+    if( capacity == 0 )
+    {
+        return kCFNotFound;
     }
     
-    h    = h % ( CFHashCode )( d->_size );
-    item = d->_items[ h ];
+    mask = capacity - 1;
+    pos  = ( CFIndex )( CF_DICTIONARY_H1( h ) & ( CFHashCode )mask );
+    h2   = CF_DICTIONARY_H2( h );
+    step = 0;
     
-    while( item )
+    while( 1 )
     {
-        if( key == item->key )
+        match = CFDictionaryGroupMatch( controls + pos, h2 );
+        
+        while( match )
         {
-            return item;
+            slot = ( pos + CFDictionaryGroupMaskFirst( match ) ) & mask;
+            
+            if( buckets[ slot ].hash == h && CFDictionaryKeysEqual( d, key, buckets[ slot ].key ) )
+            {
+                return slot;
+            }
+            
+            match &= match - 1;
         }
         
-        if( d->_keyCallbacks.equal && d->_keyCallbacks.equal( key, item->key ) )
+        if( CFDictionaryGroupMatchEmpty( controls + pos ) )
         {
-            return item;
+            return kCFNotFound;
         }
         
-        item = item->next;
+        step += CF_DICTIONARY_GROUP_WIDTH;
+        pos   = ( pos + step ) & mask;
     }
-    
-    return NULL;
 }
 
-bool CFDictionaryInsert( struct CFDictionary * d, const void * key, const void * value, bool expandIfNeeded )
+CFIndex CFDictionaryProbeInsertSlot( const int8_t * controls, CFIndex capacity, CFHashCode h )
 {
-    struct CFDictionaryItem * item;
-    CFHashCode                h;
-    CFAllocatorRef            alloc;
+    CFIndex               mask;
+    CFIndex               pos;
+    CFIndex               step;
+    CFDictionaryGroupMask match;
+    
+    mask = capacity - 1;
+    pos  = ( CFIndex )( CF_DICTIONARY_H1( h ) & ( CFHashCode )mask );
+    step = 0;
     
-    if( d == NULL || d->_items == NULL )
+    while( 1 )
     {
-        return false;
+        match = CFDictionaryGroupMatchEmptyOrDeleted( controls + pos );
+        
+        if( match )
+        {
+            return ( pos + CFDictionaryGroupMaskFirst( match ) ) & mask;
+        }
+        
+        step += CF_DICTIONARY_GROUP_WIDTH;
+        pos   = ( pos + step ) & mask;
     }
+}
+
+CFIndex CFDictionaryProbeKeyOrInsertSlot( CFDictionaryRef d, const void * key, CFHashCode h, CFIndex * insert )
+{
+    CFIndex               mask;
+    CFIndex               pos;
+    CFIndex               step;
+    CFIndex               slot;
+    int8_t                h2;
+    CFDictionaryGroupMask match;
     
-    alloc = CFGetAllocator( d );
-    item  = CFDictionaryGetItem( d, key );
+    mask    = d->_capacity - 1;
+    pos     = ( CFIndex )( CF_DICTIONARY_H1( h ) & ( CFHashCode )mask );
+    h2      = CF_DICTIONARY_H2( h );
+    step    = 0;
+    *insert = kCFNotFound;
     
-    if( item )
+    while( 1 )
     {
-        if( d->_valueCallbacks.release )
+        match = CFDictionaryGroupMatch( d->_controls + pos, h2 );
+        
+        while( match )
         {
-            d->_valueCallbacks.release( alloc, item->value );
+            slot = ( pos + CFDictionaryGroupMaskFirst( match ) ) & mask;
+            
+            if( d->_buckets[ slot ].hash == h && CFDictionaryKeysEqual( d, key, d->_buckets[ slot ].key ) )
+            {
+                return slot;
+            }
+            
+            match &= match - 1;
         }
         
-        if( d->_valueCallbacks.retain )
+        /* Same slot CFDictionaryProbeInsertSlot would return, as groups are visited in the same order */
+        if( *insert == kCFNotFound )
         {
-            item->value = d->_valueCallbacks.retain( alloc, value );
+            match = CFDictionaryGroupMatchEmptyOrDeleted( d->_controls + pos );
+            
+            if( match )
+            {
+                *insert = ( pos + CFDictionaryGroupMaskFirst( match ) ) & mask;
+            }
         }
-        else
+        
+        if( CFDictionaryGroupMatchEmpty( d->_controls + pos ) )
         {
-            item->value = value;
+            return kCFNotFound;
         }
         
-        return true;
+        step += CF_DICTIONARY_GROUP_WIDTH;
+        pos   = ( pos + step ) & mask;
     }
+}
+
+struct CFDictionaryBucket * CFDictionaryFind( CFDictionaryRef d, const void * key, CFHashCode h )
+{
+    CFIndex slot;
     
-    item = CFAllocatorAllocate( alloc, sizeof( struct CFDictionaryItem ), 0 );
-    
-    if( item == NULL )
+    if( d->_frozen )
     {
-        return false;
+        return CFDictionaryFindFrozen( d, key, h );
     }
     
-    if( d->_keyCallbacks.retain )
+    if( d->_buckets == NULL )
     {
-        item->key = d->_keyCallbacks.retain( alloc, key );
-    }
-    else
-    {
-        item->key = key;
+        for( slot = 0; slot < d->_count; slot++ )
+        {
+            if( d->_inline[ slot ].hash == h && CFDictionaryKeysEqual( d, key, d->_inline[ slot ].key ) )
+            {
+                return ( struct CFDictionaryBucket * )&( d->_inline[ slot ] );
+            }
+        }
+        
+        return NULL;
     }
     
-    if( d->_valueCallbacks.retain )
-    {
-        item->value = d->_valueCallbacks.retain( alloc, value );
-    }
-    else
-    {
-        item->value = value;
-    }
+    slot = CFDictionaryProbe( d, d->_buckets, d->_controls, d->_capacity, key, h );
     
-    if( d->_keyCallbacks.hash )
+    if( slot != kCFNotFound )
     {
-        h = d->_keyCallbacks.hash( key );
+        return &( d->_buckets[ slot ] );
     }
-    else
+    
+    if( d->_oldBuckets == NULL )
     {
-        h = ( uint64_t )key;
+        return NULL;
     }
     
-    h = h % ( CFHashCode )( d->_size );
+    /* Buckets that were not migrated yet */
+    slot = CFDictionaryProbe( d, d->_oldBuckets, d->_oldControls, d->_oldCapacity, key, h );
     
-    item->next     = d->_items[ h ];
-    d->_items[ h ] = item;
+    return ( slot == kCFNotFound ) ? NULL : &( d->_oldBuckets[ slot ] );
+}
+
+struct CFDictionaryBucket * CFDictionaryFindFrozen( CFDictionaryRef d, const void * key, CFHashCode h )
+{
+    struct CFDictionaryBucket * bucket;
     
-    d->_count++;
+    bucket = &( d->_buckets[ CFDictionaryFrozenSlot( h, d->_seeds[ h >> d->_seedShift ], d->_count ) ] );
     
-    if( expandIfNeeded && d->_count >= d->_size * CF_DICTIONARY_MAX_LOAD_FACTOR )
+    if( bucket->hash == h && CFDictionaryKeysEqual( d, key, bucket->key ) )
     {
-        CFDictionaryResize( d, d->_size * CF_DICTIONARY_GROWTH_FACTOR );
+        return bucket;
     }
     
-    return true;
+    return NULL;
 }
 
-void CFDictionaryResize( CFDictionaryRef d, CFIndex size )
+CFIndex CFDictionaryFrozenSlot( CFHashCode h, uint32_t seed, CFIndex count )
 {
-    CFAllocatorRef             alloc;
-    struct CFDictionary      * d2;
-    CFDictionaryKeyCallBacks   kCallbacks;
-    CFDictionaryValueCallBacks vCallbacks;
-    CFIndex                    i;
-    struct CFDictionaryItem  * item;
-    
-    if( d == NULL )
-    {
-        return;
-    }
+    h += ( CFHashCode )seed * ( CFHashCode )0x9E3779B97F4A7C15ULL;
+    h ^= h >> 32;
+    h *= ( CFHashCode )0xD6E8FEB86659FD93ULL;
+    h ^= h >> 32;
     
-    alloc = CFGetAllocator( d );
-    d2    = ( struct CFDictionary * )CFRuntimeCreateInstance( alloc, CFDictionaryTypeID );
+    /* Maps the low 32 bits to [ 0, count ) without a division */
+    return ( CFIndex )( ( ( h & 0xFFFFFFFFULL ) * ( uint64_t )count ) >> 32 );
+}
+
+struct CFDictionaryBucket * CFDictionaryNextBucket( CFDictionaryRef d, CFIndex * index )
+{
+    CFIndex i;
     
-    if( d2 == NULL )
+    if( d->_frozen )
     {
-        return;
+        return ( *( index ) < d->_count ) ? &( d->_buckets[ ( *( index ) )++ ] ) : NULL;
     }
     
-    d2->_items = CFAllocatorAllocate( alloc, ( size ) ? size * ( CFIndex )sizeof( struct CFDictionaryItem * ) : sizeof( struct CFDictionaryItem * ), 0 );
-    
-    if( d2->_items == NULL )
+    if( d->_buckets == NULL )
     {
-        CFRelease( d2 );
-        
-        return;
+        return ( *( index ) < d->_count ) ? ( struct CFDictionaryBucket * )&( d->_inline[ ( *( index ) )++ ] ) : NULL;
     }
     
-    d2->_size                  = size;
-    d2->_keyCallbacks          = d->_keyCallbacks;
-    d2->_valueCallbacks        = d->_valueCallbacks;
-    kCallbacks                 = d2->_keyCallbacks;
-    vCallbacks                 = d2->_valueCallbacks;
-    d2->_keyCallbacks.retain   = NULL;
-    d2->_valueCallbacks.retain = NULL;
-    
-    for( i = 0; i < d->_size; i++ )
+    while( *( index ) < d->_capacity + d->_oldCapacity )
     {
-        item = d->_items[ i ];
+        i = ( *( index ) )++;
         
-        while( item )
+        if( i < d->_capacity )
         {
-            CFDictionaryInsert( d2, item->key, item->value, false );
-            
-            item = item->next;
+            if( CF_DICTIONARY_CONTROL_IS_FULL( d->_controls[ i ] ) )
+            {
+                return &( d->_buckets[ i ] );
+            }
+        }
+        else if( CF_DICTIONARY_CONTROL_IS_FULL( d->_oldControls[ i - d->_capacity ] ) )
+        {
+            return &( d->_oldBuckets[ i - d->_capacity ] );
         }
     }
     
-    d2->_keyCallbacks   = kCallbacks;
-    d2->_valueCallbacks = vCallbacks;
-    
-    ( ( struct CFDictionary * )d )->_keyCallbacks.release   = NULL;
-    ( ( struct CFDictionary * )d )->_valueCallbacks.release = NULL;
-    
-    CFDictionarySwap( d, d2 );
-    CFRelease( d2 );
+    return NULL;
 }
 
-void CFDictionarySwap( CFDictionaryRef d1, CFDictionaryRef d2 )
+struct CFDictionaryBucket * CFDictionaryGetBucket( CFDictionaryRef d, const void * key )
 {
-    struct CFDictionary   tmp;
-    struct CFDictionary * p1;
-    struct CFDictionary * p2;
+    if( d == NULL || d->_count == 0 )
+    {
+        return NULL;
+    }
     
-    if( d1 == NULL || d2 == NULL )
+    return CFDictionaryFind( d, key, CFDictionaryHashKey( d, key ) );
+}
+
+struct CFDictionaryBucket * CFDictionaryGetIntegerBucket( CFDictionaryRef d, SInt64 key )
+{
+    if( d == NULL || d->_count == 0 )
     {
-        return;
+        return NULL;
     }
     
-    p1 = ( struct CFDictionary * )d1;
-    p2 = ( struct CFDictionary * )d2;
+    CFDictionaryAssertIntegerKeys( d );
     
-    tmp     = *( p1 );
-    *( p1 ) = *( p2 );
-    *( p2 ) = tmp;
+    return CFDictionaryFind( d, ( const void * )( intptr_t )key, CFDictionaryHashInteger( key ) );
 }
 
-void CFDictionaryAssertMutable( CFDictionaryRef d )
+bool CFDictionaryInsert( struct CFDictionary * d, const void * key, const void * value )
 {
     if( d == NULL )
     {
-        return;
+        return false;
     }
     
-    if( d->_mutable == false )
-    {
-        CFRuntimeAbortWithError( "<CFDictionary 0x%llu> is not mutable", ( unsigned long long )d );
-    }
+    return CFDictionaryInsertWithHash( d, key, value, CFDictionaryHashKey( d, key ) );
 }
 
-const CFDictionaryKeyCallBacks kCFCopyStringDictionaryKeyCallBacks =
+bool CFDictionaryInsertWithHash( struct CFDictionary * d, const void * key, const void * value, CFHashCode h )
 {
-    0,
-    ( const void * ( * )( CFAllocatorRef, const void * ) )CFStringCreateCopy,
-    CFDictionaryCallbackRelease,
-    CFCopyDescription,
-    CFEqual,
-    CFHash
-};
+    return CFDictionaryStoreWithHash( d, key, value, h, true );
+}
 
-const CFDictionaryKeyCallBacks kCFTypeDictionaryKeyCallBacks =
+bool CFDictionaryStoreWithHash( struct CFDictionary * d, const void * key, const void * value, CFHashCode h, bool replace )
 {
-    0,
-    CFDictionaryCallbackRetain,
-    CFDictionaryCallbackRelease,
-    CFCopyDescription,
-    CFEqual,
-    CFHash
+    struct CFDictionaryBucket * bucket;
+    CFIndex                     slot;
+    CFIndex                     found;
+    CFIndex                     capacity;
+    CFAllocatorRef              alloc;
+    const void                * old;
+    
+    if( d == NULL )
+    {
+        return false;
+    }
+    
+    if( d->_oldBuckets )
+    {
+        CFDictionaryMigrate( d, CF_DICTIONARY_MIGRATION_STEP );
+    }
+    
+    alloc = CFGetAllocator( d );
+    
+    if( d->_frozen == false && d->_buckets )
+    {
+        /* Looks for the key and for an insert slot in a single probe */
+        found  = CFDictionaryProbeKeyOrInsertSlot( d, key, h, &slot );
+        bucket = ( found == kCFNotFound ) ? NULL : &( d->_buckets[ found ] );
+        
+        if( bucket == NULL && d->_oldBuckets )
+        {
+            found  = CFDictionaryProbe( d, d->_oldBuckets, d->_oldControls, d->_oldCapacity, key, h );
+            bucket = ( found == kCFNotFound ) ? NULL : &( d->_oldBuckets[ found ] );
+        }
+    }
+    else
+    {
+        bucket = CFDictionaryFind( d, key, h );
+        slot   = kCFNotFound;
+    }
+    
+    if( bucket && replace == false )
+    {
+        return true;
+    }
+    
+    if( bucket )
+    {
+        old = bucket->value;
+        
+        if( d->_valueCallbacks.retain )
+        {
+            bucket->value = d->_valueCallbacks.retain( alloc, value );
+        }
+        else
+        {
+            bucket->value = value;
+        }
+        
+        CFDictionaryUnindexValue( d, old );
+        CFDictionaryIndexValue( d, bucket->value );
+        
+        if( d->_valueCallbacks.release )
+        {
+            d->_valueCallbacks.release( alloc, old );
+        }
+        
+        return true;
+    }
+    
+    if( d->_buckets == NULL && d->_count < CF_DICTIONARY_INLINE_CAPACITY )
+    {
+        return CFDictionaryFill( d, &( d->_inline[ d->_count ] ), key, value, h );
+    }
+    
+    if( slot == kCFNotFound || ( d->_growthLeft == 0 && d->_controls[ slot ] == CF_DICTIONARY_CONTROL_EMPTY ) )
+    {
+        if( d->_capacity == 0 )
+        {
+            /* Promotes inline buckets to a table */
+            capacity = CFDictionaryCapacityForCount( d->_count + 1 );
+        }
+        else if( d->_count <= CF_DICTIONARY_MAX_LOAD( d->_capacity ) / 2 )
+        {
+            /* Mostly deleted buckets - Rehashes at the same capacity to purge them */
+            capacity = d->_capacity;
+        }
+        else
+        {
+            capacity = d->_capacity * CF_DICTIONARY_GROWTH_FACTOR;
+        }
+        
+        if( CFDictionaryResize( d, capacity ) == false )
+        {
+            return false;
+        }
+        
+        slot = CFDictionaryProbeInsertSlot( d->_controls, d->_capacity, h );
+    }
+    
+    if( d->_controls[ slot ] == CF_DICTIONARY_CONTROL_EMPTY )
+    {
+        d->_growthLeft--;
+    }
+    
+    CFDictionarySetControl( d->_controls, d->_capacity, slot, CF_DICTIONARY_H2( h ) );
+    
+    return CFDictionaryFill( d, &( d->_buckets[ slot ] ), key, value, h );
+}
+
+bool CFDictionaryFill( struct CFDictionary * d, struct CFDictionaryBucket * bucket, const void * key, const void * value, CFHashCode h )
+{
+    CFAllocatorRef alloc;
+    
+    alloc        = CFGetAllocator( d );
+    bucket->hash = h;
+    
+    if( d->_keyCallbacks.retain )
+    {
+        bucket->key = d->_keyCallbacks.retain( alloc, key );
+    }
+    else
+    {
+        bucket->key = key;
+    }
+    
+    if( d->_valueCallbacks.retain )
+    {
+        bucket->value = d->_valueCallbacks.retain( alloc, value );
+    }
+    else
+    {
+        bucket->value = value;
+    }
+    
+    d->_count++;
+    
+    CFDictionaryIndexValue( d, bucket->value );
+    
+    return true;
+}
+
+void CFDictionaryHashBuckets( CFDictionaryRef d, struct CFDictionaryBucket * buckets, const void ** keys, const void ** values, CFIndex count )
+{
+    CFIndex i;
+    
+    for( i = 0; i < count; i++ )
+    {
+        buckets[ i ].key   = keys[ i ];
+        buckets[ i ].value = values[ i ];
+        buckets[ i ].hash  = CFDictionaryHashKey( d, keys[ i ] );
+    }
+}
+
+bool CFDictionaryInsertBuckets( struct CFDictionary * d, const struct CFDictionaryBucket * buckets, CFIndex count, bool replace )
+{
+    CFIndex i;
+    
+    for( i = 0; i < count; i++ )
+    {
+        if( CFDictionaryStoreWithHash( d, buckets[ i ].key, buckets[ i ].value, buckets[ i ].hash, replace ) == false )
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+bool CFDictionaryReserve( struct CFDictionary * d, CFIndex count )
+{
+    CFIndex capacity;
+    
+    capacity = CFDictionaryCapacityForCount( count );
+    
+    if( capacity <= ( ( d->_buckets ) ? d->_capacity : 0 ) )
+    {
+        return true;
+    }
+    
+    return CFDictionaryResize( d, capacity );
+}
+
+void CFDictionaryErase( struct CFDictionary * d, struct CFDictionaryBucket * bucket )
+{
+    CFAllocatorRef            alloc;
+    struct CFDictionaryBucket erased;
+    
+    alloc  = CFGetAllocator( d );
+    erased = *( bucket );
+    
+    CFDictionaryDetach( d, bucket );
+    CFDictionaryUnindexValue( d, erased.value );
+    
+    if( d->_keyCallbacks.release )
+    {
+        d->_keyCallbacks.release( alloc, erased.key );
+    }
+    
+    if( d->_valueCallbacks.release )
+    {
+        d->_valueCallbacks.release( alloc, erased.value );
+    }
+}
+
+void CFDictionaryRemove( struct CFDictionary * d, const void * key, CFHashCode h )
+{
+    struct CFDictionaryBucket * bucket;
+    
+    if( d->_count == 0 )
+    {
+        return;
+    }
+    
+    if( d->_oldBuckets )
+    {
+        CFDictionaryMigrate( d, CF_DICTIONARY_MIGRATION_STEP );
+    }
+    
+    bucket = CFDictionaryFind( d, key, h );
+    
+    if( bucket )
+    {
+        CFDictionaryErase( d, bucket );
+        CFDictionaryShrink( d );
+    }
+}
+
+void CFDictionaryDetach( struct CFDictionary * d, struct CFDictionaryBucket * bucket )
+{
+    if( d->_buckets == NULL )
+    {
+        /* Keeps inline buckets contiguous */
+        *( bucket ) = d->_inline[ d->_count - 1 ];
+    }
+    else if( bucket >= d->_buckets && bucket < d->_buckets + d->_capacity )
+    {
+        CFDictionarySetControl( d->_controls, d->_capacity, bucket - d->_buckets, CF_DICTIONARY_CONTROL_DELETED );
+    }
+    else
+    {
+        CFDictionarySetControl( d->_oldControls, d->_oldCapacity, bucket - d->_oldBuckets, CF_DICTIONARY_CONTROL_DELETED );
+    }
+    
+    d->_count--;
+}
+
+void CFDictionaryEraseAll( struct CFDictionary * d )
+{
+    CFIndex i;
+    
+    /* Every value goes, so the index is cleared at once */
+    if( d->_valueIndex )
+    {
+        CFDictionaryEraseAll( d->_valueIndex );
+    }
+    
+    /* No need to copy shared entries that would be erased */
+    CFDictionaryUnshare( d, false );
+    
+    CFDictionaryMigrate( d, -1 );
+    
+    if( d->_buckets == NULL )
+    {
+        while( d->_count )
+        {
+            CFDictionaryErase( d, &( d->_inline[ d->_count - 1 ] ) );
+        }
+        
+        return;
+    }
+    
+    for( i = 0; i < d->_capacity; i++ )
+    {
+        if( CF_DICTIONARY_CONTROL_IS_FULL( d->_controls[ i ] ) )
+        {
+            CFDictionaryErase( d, &( d->_buckets[ i ] ) );
+        }
+    }
+    
+    /* The table is released, as the dictionary may never grow that much again */
+    CFDictionaryResize( d, 0 );
+}
+
+void CFDictionarySetControl( int8_t * controls, CFIndex capacity, CFIndex slot, int8_t control )
+{
+    /*
+     * Also writes the mirrored control byte, if slot is in the first group.
+     * Otherwise, this writes the same byte twice.
+     */
+    controls[ slot ] = control;
+    controls[ ( ( slot - CF_DICTIONARY_GROUP_WIDTH ) & ( capacity - 1 ) ) + CF_DICTIONARY_GROUP_WIDTH ] = control;
+}
+
+bool CFDictionaryResize( struct CFDictionary * d, CFIndex capacity )
+{
+    CFAllocatorRef              alloc;
+    struct CFDictionaryBucket * buckets;
+    CFIndex                     i;
+    CFIndex                     n;
+    
+    if( d == NULL || capacity < CFDictionaryCapacityForCount( d->_count ) )
+    {
+        return false;
+    }
+    
+    alloc = CFGetAllocator( d );
+    
+    d->_resizes++;
+    
+    if( capacity == 0 )
+    {
+        /* Moves the remaining entries back inline */
+        CFDictionaryMigrate( d, -1 );
+        
+        if( d->_buckets == NULL )
+        {
+            return true;
+        }
+        
+        for( i = 0, n = 0; i < d->_capacity; i++ )
+        {
+            if( CF_DICTIONARY_CONTROL_IS_FULL( d->_controls[ i ] ) )
+            {
+                d->_inline[ n++ ] = d->_buckets[ i ];
+            }
+        }
+        
+        CFAllocatorDeallocate( alloc, d->_buckets );
+        
+        d->_buckets    = NULL;
+        d->_controls   = NULL;
+        d->_capacity   = 0;
+        d->_growthLeft = 0;
+        
+        return true;
+    }
+    
+    buckets = CFAllocatorAllocate( alloc, capacity * ( CFIndex )sizeof( struct CFDictionaryBucket ) + capacity + CF_DICTIONARY_GROUP_WIDTH, 0 );
+    
+    if( buckets == NULL )
+    {
+        return false;
+    }
+    
+    /* A single migration can be pending */
+    CFDictionaryMigrate( d, -1 );
+    
+    if( d->_buckets == NULL )
+    {
+        d->_buckets    = buckets;
+        d->_controls   = ( int8_t * )( buckets + capacity );
+        d->_capacity   = capacity;
+        d->_growthLeft = CF_DICTIONARY_MAX_LOAD( capacity ) - d->_count;
+        
+        memset( d->_controls, ( uint8_t )CF_DICTIONARY_CONTROL_EMPTY, ( size_t )( capacity + CF_DICTIONARY_GROUP_WIDTH ) );
+        
+        for( i = 0; i < d->_count; i++ )
+        {
+            CFDictionaryPlace( d, &( d->_inline[ i ] ) );
+        }
+        
+        CFDictionarySample( d );
+        
+        return true;
+    }
+    
+    d->_oldBuckets  = d->_buckets;
+    d->_oldControls = d->_controls;
+    d->_oldCapacity = d->_capacity;
+    d->_migrated    = 0;
+    d->_buckets     = buckets;
+    d->_controls    = ( int8_t * )( buckets + capacity );
+    d->_capacity    = capacity;
+    d->_growthLeft  = CF_DICTIONARY_MAX_LOAD( capacity ) - d->_count;
+    
+    memset( d->_controls, ( uint8_t )CF_DICTIONARY_CONTROL_EMPTY, ( size_t )( capacity + CF_DICTIONARY_GROUP_WIDTH ) );
+    
+    if( d->_incremental == false )
+    {
+        CFDictionaryMigrate( d, -1 );
+    }
+    
+    return true;
+}
+
+void CFDictionaryShrink( struct CFDictionary * d )
+{
+    CFIndex capacity;
+    
+    /*
+     * Tables grow at CF_DICTIONARY_MAX_LOAD, and shrink below
+     * CF_DICTIONARY_MIN_LOAD to a capacity for twice the count, so
+     * alternating insertions and removals never resize back and forth.
+     * A pending migration is completed first by the following removals.
+     */
+    if( d->_buckets == NULL || d->_oldBuckets || d->_count > CF_DICTIONARY_MIN_LOAD( d->_capacity ) )
+    {
+        return;
+    }
+    
+    capacity = CFDictionaryCapacityForCount( d->_count * 2 );
+    
+    if( capacity < d->_capacity )
+    {
+        CFDictionaryResize( d, capacity );
+    }
+}
+
+void CFDictionaryMigrate( struct CFDictionary * d, CFIndex count )
+{
+    CFIndex i;
+    
+    if( d->_oldBuckets == NULL )
+    {
+        return;
+    }
+    
+    /*
+     * Migrated buckets are marked as deleted in the old table, so lookups
+     * probing it never see them twice.
+     * Space for all of them was reserved in the new table by the resize.
+     */
+    while( d->_migrated < d->_oldCapacity && count-- != 0 )
+    {
+        i = d->_migrated++;
+        
+        if( CF_DICTIONARY_CONTROL_IS_FULL( d->_oldControls[ i ] ) == false )
+        {
+            continue;
+        }
+        
+        CFDictionaryPlace( d, &( d->_oldBuckets[ i ] ) );
+        CFDictionarySetControl( d->_oldControls, d->_oldCapacity, i, CF_DICTIONARY_CONTROL_DELETED );
+    }
+    
+    if( d->_migrated == d->_oldCapacity )
+    {
+        CFAllocatorDeallocate( CFGetAllocator( d ), d->_oldBuckets );
+        
+        d->_oldBuckets  = NULL;
+        d->_oldControls = NULL;
+        d->_oldCapacity = 0;
+        d->_migrated    = 0;
+        
+        /* The new table is complete */
+        CFDictionarySample( d );
+    }
+}
+
+void CFDictionaryPlace( struct CFDictionary * d, const struct CFDictionaryBucket * bucket )
+{
+    CFIndex slot;
+    
+    slot = CFDictionaryProbeInsertSlot( d->_controls, d->_capacity, bucket->hash );
+    
+    CFDictionarySetControl( d->_controls, d->_capacity, slot, CF_DICTIONARY_H2( bucket->hash ) );
+    
+    d->_buckets[ slot ] = *( bucket );
+}
+
+CFDictionaryRef CFDictionaryCreateImmutable( CFAllocatorRef allocator, const void ** keys, const void ** values, CFIndex numValues, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks, bool freeze )
+{
+    struct CFDictionary       * o;
+    struct CFDictionaryBucket   small[ CF_DICTIONARY_INLINE_CAPACITY ];
+    struct CFDictionaryBucket * buckets;
+    bool                        success;
+    
+    o = ( struct CFDictionary * )CFRuntimeCreateInstance( allocator, CFDictionaryTypeID );
+    
+    if( o == NULL )
+    {
+        return NULL;
+    }
+    
+    if( keyCallBacks )
+    {
+        o->_keyCallbacks = *( keyCallBacks );
+    }
+    
+    if( valueCallBacks )
+    {
+        o->_valueCallbacks = *( valueCallBacks );
+    }
+    
+    if( numValues <= 0 )
+    {
+        return o;
+    }
+    
+    buckets = ( numValues <= CF_DICTIONARY_INLINE_CAPACITY ) ? small : CFAllocatorAllocate( allocator, numValues * ( CFIndex )sizeof( struct CFDictionaryBucket ), 0 );
+    
+    if( buckets == NULL )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    CFDictionaryHashBuckets( o, buckets, keys, values, numValues );
+    
+    /* Small dictionaries, or keys with colliding hashes, are not frozen */
+    success = ( freeze && numValues > CF_DICTIONARY_INLINE_CAPACITY && CFDictionaryFreeze( o, buckets, numValues ) )
+           || ( CFDictionaryReserve( o, numValues ) && CFDictionaryInsertBuckets( o, buckets, numValues, true ) );
+    
+    if( buckets != small )
+    {
+        CFAllocatorDeallocate( allocator, buckets );
+    }
+    
+    if( success == false )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    return o;
+}
+
+CFDictionaryRef CFDictionaryCreateImmutableCopy( CFAllocatorRef allocator, CFDictionaryRef theDict, bool freeze )
+{
+    struct CFDictionary       * o;
+    CFIndex                     i;
+    CFIndex                     n;
+    struct CFDictionaryBucket * bucket;
+    struct CFDictionaryBucket * buckets;
+    bool                        success;
+    
+    if( theDict == NULL )
+    {
+        return NULL;
+    }
+    
+    /* An immutable dictionary is its own copy, unless it has a table to freeze */
+    if
+    (
+           theDict->_mutable == false
+        && ( freeze == false || theDict->_frozen || theDict->_buckets == NULL )
+        && CFGetAllocator( theDict ) == ( ( allocator ) ? allocator : CFAllocatorGetDefault() )
+    )
+    {
+        return CFRetain( theDict );
+    }
+    
+    o = ( struct CFDictionary * )CFRuntimeCreateInstance( allocator, CFDictionaryTypeID );
+    
+    if( o == NULL )
+    {
+        return NULL;
+    }
+    
+    o->_keyCallbacks    = theDict->_keyCallbacks;
+    o->_valueCallbacks  = theDict->_valueCallbacks;
+    i                   = 0;
+    
+    /* A table is not shared when a frozen copy is requested */
+    if( ( freeze == false || theDict->_frozen ) && CFDictionaryShare( o, theDict ) )
+    {
+        return o;
+    }
+    
+    /* Same key callbacks, so the cached hashes are valid for the copy */
+    if( freeze == false || theDict->_count <= CF_DICTIONARY_INLINE_CAPACITY )
+    {
+        if( CFDictionaryReserve( o, theDict->_count ) == false )
+        {
+            CFRelease( o );
+            
+            return NULL;
+        }
+        
+        while( ( bucket = CFDictionaryNextBucket( theDict, &i ) ) )
+        {
+            if( CFDictionaryInsertWithHash( o, bucket->key, bucket->value, bucket->hash ) == false )
+            {
+                CFRelease( o );
+                
+                return NULL;
+            }
+        }
+        
+        return o;
+    }
+    
+    buckets = CFAllocatorAllocate( allocator, theDict->_count * ( CFIndex )sizeof( struct CFDictionaryBucket ), 0 );
+    
+    if( buckets == NULL )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    n = 0;
+    
+    while( ( bucket = CFDictionaryNextBucket( theDict, &i ) ) )
+    {
+        buckets[ n++ ] = *( bucket );
+    }
+    
+    /* Keys with colliding hashes can't be frozen, so they get a table */
+    success = CFDictionaryFreeze( o, buckets, n )
+           || ( CFDictionaryReserve( o, n ) && CFDictionaryInsertBuckets( o, buckets, n, true ) );
+    
+    CFAllocatorDeallocate( allocator, buckets );
+    
+    if( success == false )
+    {
+        CFRelease( o );
+        
+        return NULL;
+    }
+    
+    return o;
+}
+
+bool CFDictionaryFreeze( struct CFDictionary * d, const struct CFDictionaryBucket * buckets, CFIndex count )
+{
+    CFAllocatorRef              alloc;
+    CFIndex                     bits;
+    CFIndex                     groups;
+    CFIndex                     i;
+    CFIndex                     j;
+    CFIndex                     k;
+    CFIndex                     g;
+    CFIndex                     start;
+    CFIndex                     end;
+    CFIndex                     n;
+    CFIndex                     size;
+    CFIndex                     maxSize;
+    uint32_t                    seed;
+    uint32_t                  * index;
+    uint32_t                  * order;
+    uint32_t                  * seeds;
+    uint64_t                  * used;
+    CFIndex                     slots[ CF_DICTIONARY_FROZEN_MAX_GROUP ];
+    struct CFDictionaryBucket * grouped;
+    struct CFDictionaryBucket * frozen;
+    bool                        success;
+    
+    if( d == NULL || d->_count != 0 || count <= 0 || count > ( CFIndex )UINT32_MAX )
+    {
+        return false;
+    }
+    
+    /* Groups of CF_DICTIONARY_FROZEN_GROUP_LOAD buckets or less, on average */
+    bits = 1;
+    
+    while( ( ( CFIndex )1 << bits ) * CF_DICTIONARY_FROZEN_GROUP_LOAD < count )
+    {
+        bits++;
+    }
+    
+    groups  = ( CFIndex )1 << bits;
+    alloc   = CFGetAllocator( d );
+    grouped = CFAllocatorAllocate( alloc, count * ( CFIndex )sizeof( struct CFDictionaryBucket ) + ( groups * 2 + 1 ) * ( CFIndex )sizeof( uint32_t ) + ( ( count + 63 ) / 64 ) * ( CFIndex )sizeof( uint64_t ), 0 );
+    
+    if( grouped == NULL )
+    {
+        return false;
+    }
+    
+    used  = ( uint64_t * )( void * )( grouped + count );
+    index = ( uint32_t * )( void * )( used + ( count + 63 ) / 64 );
+    order = index + groups + 1;
+    
+    memset( used,  0, ( size_t )( ( count + 63 ) / 64 ) * sizeof( uint64_t ) );
+    memset( index, 0, ( size_t )( groups + 1 ) * sizeof( uint32_t ) );
+    
+    /* Counting sort by hash prefix - index[ g ] becomes the start of group g */
+    for( i = 0; i < count; i++ )
+    {
+        index[ ( buckets[ i ].hash >> ( 64 - bits ) ) + 1 ]++;
+    }
+    
+    for( i = 0; i < groups; i++ )
+    {
+        index[ i + 1 ] += index[ i ];
+    }
+    
+    for( i = 0; i < count; i++ )
+    {
+        grouped[ index[ buckets[ i ].hash >> ( 64 - bits ) ]++ ] = buckets[ i ];
+    }
+    
+    /*
+     * index[ g ] is now the end of group g. Removes duplicate keys (the last
+     * value wins, as the sort is stable) while shifting the groups back.
+     * Distinct keys with the same hash can't be told apart by the slot
+     * function, so they are not frozen.
+     */
+    success = true;
+    maxSize = 0;
+    
+    for( n = 0, start = 0, i = 0; i < groups; i++ )
+    {
+        end        = index[ i ];
+        index[ i ] = ( uint32_t )n;
+        
+        for( ; start < end; start++ )
+        {
+            for( j = index[ i ]; j < n; j++ )
+            {
+                if( grouped[ j ].hash == grouped[ start ].hash )
+                {
+                    break;
+                }
+            }
+            
+            if( j == n )
+            {
+                grouped[ n++ ] = grouped[ start ];
+            }
+            else if( CFDictionaryKeysEqual( d, grouped[ j ].key, grouped[ start ].key ) )
+            {
+                grouped[ j ].value = grouped[ start ].value;
+            }
+            else
+            {
+                success = false;
+            }
+        }
+        
+        maxSize = ( n - index[ i ] > maxSize ) ? n - index[ i ] : maxSize;
+    }
+    
+    index[ groups ] = ( uint32_t )n;
+    
+    if( success == false || maxSize > CF_DICTIONARY_FROZEN_MAX_GROUP )
+    {
+        CFAllocatorDeallocate( alloc, grouped );
+        
+        return false;
+    }
+    
+    frozen = CFAllocatorAllocate( alloc, n * ( CFIndex )sizeof( struct CFDictionaryBucket ) + groups * ( CFIndex )sizeof( uint32_t ), 0 );
+    
+    if( frozen == NULL )
+    {
+        CFAllocatorDeallocate( alloc, grouped );
+        
+        return false;
+    }
+    
+    seeds = ( uint32_t * )( void * )( frozen + n );
+    
+    memset( seeds, 0, ( size_t )groups * sizeof( uint32_t ) );
+    
+    /* Places the largest groups first, while most slots are still free */
+    for( size = maxSize, k = 0; size > 0; size-- )
+    {
+        for( g = 0; g < groups; g++ )
+        {
+            if( ( CFIndex )( index[ g + 1 ] - index[ g ] ) == size )
+            {
+                order[ k++ ] = ( uint32_t )g;
+            }
+        }
+    }
+    
+    for( i = 0; i < k && success; i++ )
+    {
+        g     = order[ i ];
+        start = index[ g ];
+        end   = index[ g + 1 ];
+        
+        /* Tries seeds until every bucket of the group lands on a free slot */
+        for( seed = 0; ; seed++ )
+        {
+            for( j = start; j < end; j++ )
+            {
+                slots[ j - start ] = CFDictionaryFrozenSlot( grouped[ j ].hash, seed, n );
+                
+                if( used[ slots[ j - start ] / 64 ] & ( ( uint64_t )1 << ( slots[ j - start ] % 64 ) ) )
+                {
+                    break;
+                }
+                
+                used[ slots[ j - start ] / 64 ] |= ( uint64_t )1 << ( slots[ j - start ] % 64 );
+            }
+            
+            if( j == end )
+            {
+                break;
+            }
+            
+            while( j-- > start )
+            {
+                used[ slots[ j - start ] / 64 ] &= ~( ( uint64_t )1 << ( slots[ j - start ] % 64 ) );
+            }
+            
+            if( seed == UINT32_MAX )
+            {
+                success = false;
+                
+                break;
+            }
+        }
+        
+        seeds[ g ] = seed;
+        
+        for( j = start; j < end && success; j++ )
+        {
+            frozen[ slots[ j - start ] ] = grouped[ j ];
+        }
+    }
+    
+    CFAllocatorDeallocate( alloc, grouped );
+    
+    if( success == false )
+    {
+        CFAllocatorDeallocate( alloc, frozen );
+        
+        return false;
+    }
+    
+    d->_buckets   = frozen;
+    d->_capacity  = n;
+    d->_seeds     = seeds;
+    d->_seedShift = 64 - bits;
+    d->_frozen    = true;
+    
+    for( i = 0; i < n; i++ )
+    {
+        if( d->_keyCallbacks.retain )
+        {
+            frozen[ i ].key = d->_keyCallbacks.retain( alloc, frozen[ i ].key );
+        }
+        
+        if( d->_valueCallbacks.retain )
+        {
+            frozen[ i ].value = d->_valueCallbacks.retain( alloc, frozen[ i ].value );
+        }
+    }
+    
+    d->_count = n;
+    
+    return true;
+}
+
+bool CFDictionaryShare( struct CFDictionary * d, CFDictionaryRef source )
+{
+    volatile CFIndex * shared;
+    
+    /* Inline buckets are cheap to copy, and a pending migration can't be shared */
+    if( source->_buckets == NULL || source->_oldBuckets || CFGetAllocator( d ) != CFGetAllocator( source ) )
+    {
+        return false;
+    }
+    
+    if( source->_shared == NULL )
+    {
+        shared = CFAllocatorAllocate( CFGetAllocator( source ), sizeof( CFIndex ), 0 );
+        
+        if( shared == NULL )
+        {
+            return false;
+        }
+        
+        *( shared ) = 1;
+        
+        /* Another thread may be copying source too */
+        if( CFAtomicCompareAndSwapPointer( NULL, ( void * )shared, ( void * volatile * )&( ( ( struct CFDictionary * )source )->_shared ) ) == false )
+        {
+            CFAllocatorDeallocate( CFGetAllocator( source ), ( void * )shared );
+        }
+    }
+    
+    CFAtomicIncrement( source->_shared );
+    
+    d->_buckets    = source->_buckets;
+    d->_controls   = source->_controls;
+    d->_capacity   = source->_capacity;
+    d->_count      = source->_count;
+    d->_growthLeft = source->_growthLeft;
+    d->_seeds      = source->_seeds;
+    d->_seedShift  = source->_seedShift;
+    d->_frozen     = source->_frozen;
+    d->_shared     = source->_shared;
+    
+    return true;
+}
+
+void CFDictionaryUnshare( struct CFDictionary * d, bool copy )
+{
+    struct CFDictionary         shared;
+    struct CFDictionary       * index;
+    struct CFDictionaryBucket * bucket;
+    CFIndex                     i;
+    
+    if( d->_shared == NULL )
+    {
+        return;
+    }
+    
+    /*
+     * Other dictionaries released the storage - No need to copy it, unless
+     * it is frozen, as mutable dictionaries need a table with control bytes.
+     */
+    if( d->_frozen == false && CFAtomicLoadAcquire( d->_shared ) == 1 )
+    {
+        CFAllocatorDeallocate( CFGetAllocator( d ), ( void * )( d->_shared ) );
+        
+        d->_shared = NULL;
+        
+        return;
+    }
+    
+    shared         = *( d );
+    d->_buckets    = NULL;
+    d->_controls   = NULL;
+    d->_capacity   = 0;
+    d->_count      = 0;
+    d->_growthLeft = 0;
+    d->_seeds      = NULL;
+    d->_seedShift  = 0;
+    d->_frozen     = false;
+    d->_shared     = NULL;
+    i              = 0;
+    
+    /* Into a table, as the frozen layout is only used by immutable dictionaries */
+    if( copy )
+    {
+        /* Same values, so the index is already up to date */
+        index          = d->_valueIndex;
+        d->_valueIndex = NULL;
+        
+        CFDictionaryReserve( d, shared._count );
+        
+        while( ( bucket = CFDictionaryNextBucket( &shared, &i ) ) )
+        {
+            CFDictionaryInsertWithHash( d, bucket->key, bucket->value, bucket->hash );
+        }
+        
+        d->_valueIndex = index;
+    }
+    
+    if( CFAtomicDecrement( shared._shared ) == 0 )
+    {
+        CFDictionaryReleaseStorage( &shared );
+    }
+}
+
+void CFDictionaryReleaseStorage( CFDictionaryRef d )
+{
+    CFAllocatorRef              alloc;
+    CFIndex                     i;
+    struct CFDictionaryBucket * bucket;
+    
+    alloc = CFGetAllocator( d );
+    i     = 0;
+    
+    while( ( bucket = CFDictionaryNextBucket( d, &i ) ) )
+    {
+        if( d->_keyCallbacks.release )
+        {
+            d->_keyCallbacks.release( alloc, bucket->key );
+        }
+        
+        if( d->_valueCallbacks.release )
+        {
+            d->_valueCallbacks.release( alloc, bucket->value );
+        }
+    }
+    
+    if( d->_buckets )
+    {
+        CFAllocatorDeallocate( alloc, d->_buckets );
+    }
+    
+    if( d->_oldBuckets )
+    {
+        CFAllocatorDeallocate( alloc, d->_oldBuckets );
+    }
+    
+    if( d->_shared )
+    {
+        CFAllocatorDeallocate( alloc, ( void * )( d->_shared ) );
+    }
+}
+
+CFIndex CFDictionaryCapacityForCount( CFIndex count )
+{
+    CFIndex capacity;
+    
+    /* No table needed, entries fit inline */
+    if( count <= CF_DICTIONARY_INLINE_CAPACITY )
+    {
+        return 0;
+    }
+    
+    capacity = CF_DICTIONARY_GROUP_WIDTH;
+    
+    while( CF_DICTIONARY_MAX_LOAD( capacity ) < count )
+    {
+        capacity *= 2;
+    }
+    
+    return capacity;
+}
+
+void CFDictionaryAssertMutable( CFDictionaryRef d )
+{
+    if( d == NULL )
+    {
+        return;
+    }
+    
+    if( d->_mutable == false )
+    {
+        CFRuntimeAbortWithError( "<CFDictionary 0x%llu> is not mutable", ( unsigned long long )d );
+    }
+}
+
+void CFDictionaryAssertIntegerKeys( CFDictionaryRef d )
+{
+    if( d == NULL )
+    {
+        return;
+    }
+    
+    if( d->_keyCallbacks.retain || d->_keyCallbacks.release || d->_keyCallbacks.equal || d->_keyCallbacks.hash )
+    {
+        CFRuntimeAbortWithError( "<CFDictionary 0x%llu> does not have integer keys", ( unsigned long long )d );
+    }
+}
+
+bool CFDictionaryCreateValueIndex( struct CFDictionary * d )
+{
+    CFDictionaryKeyCallBacks    callbacks;
+    struct CFDictionaryBucket * bucket;
+    CFIndex                     i;
+    
+    /*
+     * Values have no hash callback. One can only be derived when values are
+     * compared by identity, or with CFEqual.
+     */
+    memset( &callbacks, 0, sizeof( CFDictionaryKeyCallBacks ) );
+    
+    if( d->_valueCallbacks.equal == CFEqual )
+    {
+        callbacks.hash = CFHash;
+    }
+    else if( d->_valueCallbacks.equal != NULL )
+    {
+        return false;
+    }
+    
+    /*
+     * The index retains its own keys: the value it first saw may be removed
+     * from d while equal values remain.
+     */
+    callbacks.retain          = d->_valueCallbacks.retain;
+    callbacks.release         = d->_valueCallbacks.release;
+    callbacks.copyDescription = d->_valueCallbacks.copyDescription;
+    callbacks.equal           = d->_valueCallbacks.equal;
+    
+    d->_valueIndex = ( struct CFDictionary * )CFDictionaryCreateMutable( CFGetAllocator( d ), 0, &callbacks, NULL );
+    
+    if( d->_valueIndex == NULL || CFDictionaryReserve( d->_valueIndex, d->_count ) == false )
+    {
+        if( d->_valueIndex )
+        {
+            CFRelease( d->_valueIndex );
+        }
+        
+        d->_valueIndex = NULL;
+        
+        return false;
+    }
+    
+    i = 0;
+    
+    while( ( bucket = CFDictionaryNextBucket( d, &i ) ) )
+    {
+        CFDictionaryIndexValue( d, bucket->value );
+    }
+    
+    return d->_valueIndex != NULL;
+}
+
+void CFDictionaryIndexValue( struct CFDictionary * d, const void * value )
+{
+    struct CFDictionaryBucket * bucket;
+    CFHashCode                  h;
+    
+    if( d->_valueIndex == NULL )
+    {
+        return;
+    }
+    
+    h      = CFDictionaryHashKey( d->_valueIndex, value );
+    bucket = CFDictionaryFind( d->_valueIndex, value, h );
+    
+    if( bucket )
+    {
+        bucket->value = ( const void * )( ( uintptr_t )( bucket->value ) + 1 );
+        
+        return;
+    }
+    
+    if( CFDictionaryInsertWithHash( d->_valueIndex, value, ( const void * )1, h ) == false )
+    {
+        /* An incomplete index would give wrong results - Lookups go back to scanning */
+        CFRelease( d->_valueIndex );
+        
+        d->_valueIndex = NULL;
+    }
+}
+
+void CFDictionaryUnindexValue( struct CFDictionary * d, const void * value )
+{
+    struct CFDictionaryBucket * bucket;
+    
+    if( d->_valueIndex == NULL )
+    {
+        return;
+    }
+    
+    bucket = CFDictionaryGetBucket( d->_valueIndex, value );
+    
+    if( bucket == NULL )
+    {
+        return;
+    }
+    
+    if( ( uintptr_t )( bucket->value ) > 1 )
+    {
+        bucket->value = ( const void * )( ( uintptr_t )( bucket->value ) - 1 );
+    }
+    else
+    {
+        CFDictionaryErase( d->_valueIndex, bucket );
+        CFDictionaryShrink( d->_valueIndex );
+    }
+}
+
+CFIndex CFDictionaryGetIndexedValueCount( CFDictionaryRef d, const void * value )
+{
+    struct CFDictionaryBucket * bucket;
+    
+    bucket = CFDictionaryGetBucket( d->_valueIndex, value );
+    
+    return ( bucket ) ? ( CFIndex )( uintptr_t )( bucket->value ) : 0;
+}
+
+CFIndex CFDictionaryProbeLength( CFHashCode h, CFIndex slot, CFIndex capacity )
+{
+    CFIndex mask;
+    CFIndex pos;
+    CFIndex step;
+    CFIndex n;
+    
+    /* Same probe sequence as CFDictionaryProbe, which visits every group */
+    mask = capacity - 1;
+    pos  = ( CFIndex )( CF_DICTIONARY_H1( h ) & ( CFHashCode )mask );
+    step = 0;
+    
+    for( n = 1; ( ( slot - pos ) & mask ) >= CF_DICTIONARY_GROUP_WIDTH; n++ )
+    {
+        step += CF_DICTIONARY_GROUP_WIDTH;
+        pos   = ( pos + step ) & mask;
+    }
+    
+    return n;
+}
+
+void CFDictionaryGetProbeStatistics( CFDictionaryRef d, struct CFDictionaryProbeStatistics * stats )
+{
+    memset( stats, 0, sizeof( struct CFDictionaryProbeStatistics ) );
+    
+    if( d->_frozen || d->_buckets == NULL )
+    {
+        stats->histogram[ 0 ] = d->_count;
+        stats->total          = d->_count;
+        stats->max            = ( d->_count ) ? 1 : 0;
+        
+        return;
+    }
+    
+    CFDictionaryAddProbeStatistics( d->_buckets, d->_controls, d->_capacity, stats );
+    
+    if( d->_oldBuckets )
+    {
+        CFDictionaryAddProbeStatistics( d->_oldBuckets, d->_oldControls, d->_oldCapacity, stats );
+    }
+}
+
+void CFDictionaryAddProbeStatistics( const struct CFDictionaryBucket * buckets, const int8_t * controls, CFIndex capacity, struct CFDictionaryProbeStatistics * stats )
+{
+    CFIndex i;
+    CFIndex n;
+    
+    for( i = 0; i < capacity; i++ )
+    {
+        if( controls[ i ] == CF_DICTIONARY_CONTROL_DELETED )
+        {
+            stats->deleted++;
+        }
+        
+        if( CF_DICTIONARY_CONTROL_IS_FULL( controls[ i ] ) == false )
+        {
+            continue;
+        }
+        
+        n             = CFDictionaryProbeLength( buckets[ i ].hash, i, capacity );
+        stats->total += n;
+        stats->max    = ( n > stats->max ) ? n : stats->max;
+        
+        stats->histogram[ ( n < CF_DICTIONARY_PROBE_HISTOGRAM ) ? n - 1 : CF_DICTIONARY_PROBE_HISTOGRAM - 1 ]++;
+    }
+}
+
+void CFDictionarySample( CFDictionaryRef d )
+{
+    struct CFDictionaryProbeStatistics stats;
+    double                             threshold;
+    double                             average;
+    
+    threshold = CFDictionaryProbeLengthThreshold;
+    
+    if( threshold <= 0 || d->_count == 0 )
+    {
+        return;
+    }
+    
+    /* Right after a rehash, long probes come from the hashes, not from deleted buckets */
+    CFDictionaryGetProbeStatistics( d, &stats );
+    
+    average = ( double )( stats.total ) / ( double )( d->_count );
+    
+    if( average <= threshold )
+    {
+        return;
+    }
+    
+    fprintf
+    (
+        stderr,
+        "\n"
+        "*** CoreFoundation - WARNING\n"
+        "*** Dictionary with an average probe length above %.2f.\n"
+        "*** The hash callback of its keys may be distributing them poorly.\n"
+        "\n"
+        "- Dictionary:            <CFDictionary 0x%llx>\n"
+        "- Count:                 %lli\n"
+        "- Capacity:              %lli\n"
+        "- Average probe length:  %.2f\n"
+        "- Maximum probe length:  %lli\n"
+        "\n",
+        threshold,
+        ( unsigned long long )( uintptr_t )d,
+        ( long long )( d->_count ),
+        ( long long )( d->_capacity ),
+        average,
+        ( long long )( stats.max )
+    );
+}
+
+CFDictionaryGroupMask CFDictionaryGroupMatch( const int8_t * group, int8_t h2 )
+{
+    #if CF_DICTIONARY_SSE2
+    
+    __m128i controls;
+    
+    controls = _mm_loadu_si128( ( const __m128i * )( const void * )group );
+    
+    return ( CFDictionaryGroupMask )_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_set1_epi8( h2 ), controls ) );
+    
+    #else
+    
+    CFDictionaryGroupMask mask;
+    CFIndex               i;
+    
+    for( mask = 0, i = 0; i < CF_DICTIONARY_GROUP_WIDTH; i++ )
+    {
+        mask |= ( CFDictionaryGroupMask )( group[ i ] == h2 ) << i;
+    }
+    
+    return mask;
+    
+    #endif
+}
+
+CFDictionaryGroupMask CFDictionaryGroupMatchEmpty( const int8_t * group )
+{
+    return CFDictionaryGroupMatch( group, CF_DICTIONARY_CONTROL_EMPTY );
+}
+
+CFDictionaryGroupMask CFDictionaryGroupMatchEmptyOrDeleted( const int8_t * group )
+{
+    #if CF_DICTIONARY_SSE2
+    
+    /* Empty and deleted are the only negative control bytes */
+    return ( CFDictionaryGroupMask )_mm_movemask_epi8( _mm_loadu_si128( ( const __m128i * )( const void * )group ) );
+    
+    #else
+    
+    CFDictionaryGroupMask mask;
+    CFIndex               i;
+    
+    for( mask = 0, i = 0; i < CF_DICTIONARY_GROUP_WIDTH; i++ )
+    {
+        mask |= ( CFDictionaryGroupMask )( group[ i ] < 0 ) << i;
+    }
+    
+    return mask;
+    
+    #endif
+}
+
+CFIndex CFDictionaryGroupMaskFirst( CFDictionaryGroupMask mask )
+{
+    #if defined( _WIN32 )
+    
+    unsigned long i;
+    
+    _BitScanForward( &i, mask );
+    
+    return ( CFIndex )i;
+    
+    #elif defined( __GNUC__ ) || defined( __clang__ )
+    
+    return __builtin_ctz( mask );
+    
+    #else
+    
+    CFIndex i;
+    
+    for( i = 0; ( mask & 1 ) == 0; i++ )
+    {
+        mask >>= 1;
+    }
+    
+    return i;
+    
+    #endif
+}
+
+const CFDictionaryKeyCallBacks kCFCopyStringDictionaryKeyCallBacks =
+{
+    0,
+    ( const void * ( * )( CFAllocatorRef, const void * ) )CFStringCreateCopy,
+    CFDictionaryCallbackRelease,
+    CFCopyDescription,
+    CFEqual,
+    CFHash
+};
+
+const CFDictionaryKeyCallBacks kCFTypeDictionaryKeyCallBacks =
+{
+    0,
+    CFDictionaryCallbackRetain,
+    CFDictionaryCallbackRelease,
+    CFCopyDescription,
+    CFEqual,
+    CFHash
+};
+
+const CFDictionaryKeyCallBacks kCFCopyStringSeededDictionaryKeyCallBacks =
+{
+    0,
+    ( const void * ( * )( CFAllocatorRef, const void * ) )CFStringCreateCopy,
+    CFDictionaryCallbackRelease,
+    CFCopyDescription,
+    CFEqual,
+    CFDictionaryCallbackSeededHash
+};
+
+const CFDictionaryKeyCallBacks kCFTypeSeededDictionaryKeyCallBacks =
+{
+    0,
+    CFDictionaryCallbackRetain,
+    CFDictionaryCallbackRelease,
+    CFCopyDescription,
+    CFEqual,
+    CFDictionaryCallbackSeededHash
 };
 
 const CFDictionaryValueCallBacks kCFTypeDictionaryValueCallBacks =
@@ -0,0 +1,200 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CFHash.c
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#ifdef _WIN32
+#define _CRT_RAND_S
+#endif
+
+#include <CoreFoundation/__private/__CFHash.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+CFOnceToken CFHashSeedOnce = CF_ONCE_INIT;
+uint64_t    CFHashSeed[ 2 ];
+
+uint64_t CFHashSipHash13( const void * bytes, size_t length, const uint64_t key[ 2 ] )
+{
+    const unsigned char * cp;
+    uint64_t              v0;
+    uint64_t              v1;
+    uint64_t              v2;
+    uint64_t              v3;
+    uint64_t              m;
+    size_t                i;
+    size_t                n;
+    
+    cp = bytes;
+    v0 = key[ 0 ] ^ 0x736F6D6570736575ULL;
+    v1 = key[ 1 ] ^ 0x646F72616E646F6DULL;
+    v2 = key[ 0 ] ^ 0x6C7967656E657261ULL;
+    v3 = key[ 1 ] ^ 0x7465646279746573ULL;
+    n  = length & ~( ( size_t )7 );
+    
+    for( i = 0; i < n; i += 8 )
+    {
+        m = ( uint64_t )cp[ i ]
+          | ( uint64_t )cp[ i + 1 ] <<  8
+          | ( uint64_t )cp[ i + 2 ] << 16
+          | ( uint64_t )cp[ i + 3 ] << 24
+          | ( uint64_t )cp[ i + 4 ] << 32
+          | ( uint64_t )cp[ i + 5 ] << 40
+          | ( uint64_t )cp[ i + 6 ] << 48
+          | ( uint64_t )cp[ i + 7 ] << 56;
+        
+        v3 ^= m;
+        
+        CF_HASH_SIP_ROUND( v0, v1, v2, v3 );
+        
+        v0 ^= m;
+    }
+    
+    /* Last block: remaining bytes, with the length in the top byte */
+    m = ( uint64_t )length << 56;
+    
+    for( i = 0; i < ( length & 7 ); i++ )
+    {
+        m |= ( uint64_t )cp[ n + i ] << ( 8 * i );
+    }
+    
+    v3 ^= m;
+    
+    CF_HASH_SIP_ROUND( v0, v1, v2, v3 );
+    
+    v0 ^= m;
+    v2 ^= 0xFF;
+    
+    CF_HASH_SIP_ROUND( v0, v1, v2, v3 );
+    CF_HASH_SIP_ROUND( v0, v1, v2, v3 );
+    CF_HASH_SIP_ROUND( v0, v1, v2, v3 );
+    
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+CFHashCode CFHashSeeded( const void * bytes, CFIndex length )
+{
+    CFOnce( &CFHashSeedOnce, CFHashCreateSeed );
+    
+    return ( CFHashCode )CFHashSipHash13( bytes, ( length < 0 ) ? 0 : ( size_t )length, CFHashSeed );
+}
+
+void CFHashCreateSeed( void )
+{
+    uint64_t fallback[ 4 ];
+    uint64_t zero[ 2 ];
+    
+    if( CFHashReadRandomBytes( CFHashSeed, sizeof( CFHashSeed ) ) )
+    {
+        return;
+    }
+    
+    /*
+     * No system entropy: derive the seed from values that change between
+     * runs. This is weaker, but still not predictable from the keys alone.
+     */
+    fallback[ 0 ] = ( uint64_t )time( NULL );
+    fallback[ 1 ] = ( uint64_t )clock();
+    fallback[ 2 ] = ( uint64_t )( uintptr_t )&fallback;
+    
+    #ifdef _WIN32
+    fallback[ 3 ] = ( uint64_t )_getpid();
+    #else
+    fallback[ 3 ] = ( uint64_t )getpid();
+    #endif
+    
+    zero[ 0 ] = 0;
+    zero[ 1 ] = 0;
+    
+    CFHashSeed[ 0 ] = CFHashSipHash13( fallback, sizeof( fallback ), zero );
+    zero[ 0 ]       = CFHashSeed[ 0 ];
+    CFHashSeed[ 1 ] = CFHashSipHash13( fallback, sizeof( fallback ), zero );
+}
+
+bool CFHashReadRandomBytes( void * bytes, size_t length )
+{
+    unsigned char * cp;
+    size_t          i;
+    
+    cp = bytes;
+    
+    #ifdef _WIN32
+    
+    {
+        unsigned int r;
+        
+        for( i = 0; i < length; i++ )
+        {
+            if( rand_s( &r ) != 0 )
+            {
+                return false;
+            }
+            
+            cp[ i ] = ( unsigned char )r;
+        }
+    }
+    
+    #else
+    
+    {
+        int     fd;
+        ssize_t n;
+        
+        fd = open( "/dev/urandom", O_RDONLY );
+        
+        if( fd == -1 )
+        {
+            return false;
+        }
+        
+        for( i = 0; i < length; i += ( size_t )n )
+        {
+            n = read( fd, cp + i, length - i );
+            
+            if( n <= 0 )
+            {
+                close( fd );
+                
+                return false;
+            }
+        }
+        
+        close( fd );
+    }
+    
+    #endif
+    
+    return true;
+}
@@ -37,6 +37,7 @@
 #include <CoreFoundation/__private/__CFBundle.h>
 #include <CoreFoundation/__private/__CFCalendar.h>
 #include <CoreFoundation/__private/__CFCharacterSet.h>
+#include <CoreFoundation/__private/__CFConcurrentDictionary.h>
 #include <CoreFoundation/__private/__CFData.h>
 #include <CoreFoundation/__private/__CFDate.h>
 #include <CoreFoundation/__private/__CFDateFormatter.h>
@@ -50,6 +51,7 @@
 #include <CoreFoundation/__private/__CFNull.h>
 #include <CoreFoundation/__private/__CFNumber.h>
 #include <CoreFoundation/__private/__CFNumberFormatter.h>
+#include <CoreFoundation/__private/__CFPersistentDictionary.h>
 #include <CoreFoundation/__private/__CFPlugIn.h>
 #include <CoreFoundation/__private/__CFPlugInInstance.h>
 #include <CoreFoundation/__private/__CFPreferences.h>
@@ -99,6 +101,7 @@ static void init( void )
     CFBundleInitialize();
     CFCalendarInitialize();
     CFCharacterSetInitialize();
+    CFConcurrentDictionaryInitialize();
     CFDataInitialize();
     CFDateInitialize();
     CFDateFormatterInitialize();
@@ -112,6 +115,7 @@ static void init( void )
     CFNullInitialize();
     CFNumberInitialize();
     CFNumberFormatterInitialize();
+    CFPersistentDictionaryInitialize();
     CFPlugInInitialize();
     CFPlugInInstanceInitialize();
     CFPreferencesInitialize();
@@ -41,9 +41,9 @@ CFRuntimeClass CFNotificationCenterClass  =
     ( CFStringRef ( * )( CFTypeRef ) )CFNotificationCenterCopyDescription
 };
 
-CFSpinLock CFNotificationCenterLocalLock       = 0;
-CFSpinLock CFNotificationCenterDarwinLock      = 0;
-CFSpinLock CFNotificationCenterDistributedLock = 0;
+CFOnceToken CFNotificationCenterLocalOnce       = CF_ONCE_INIT;
+CFOnceToken CFNotificationCenterDarwinOnce      = CF_ONCE_INIT;
+CFOnceToken CFNotificationCenterDistributedOnce = CF_ONCE_INIT;
 
 CFNotificationCenterRef CFNotificationCenterLocal       = NULL;
 CFNotificationCenterRef CFNotificationCenterDarwin      = NULL;
@@ -87,3 +87,33 @@ CFStringRef CFNotificationCenterCopyDescription( CFNotificationCenterRef center
     
     return NULL;
 }
+
+void CFNotificationCenterCreateLocal( void )
+{
+    CFNotificationCenterLocal = CFNotificationCenterCreate( NULL );
+    
+    if( CFNotificationCenterLocal )
+    {
+        CFRuntimeSetObjectAsConstant( CFNotificationCenterLocal );
+    }
+}
+
+void CFNotificationCenterCreateDarwin( void )
+{
+    CFNotificationCenterDarwin = CFNotificationCenterCreate( NULL );
+    
+    if( CFNotificationCenterDarwin )
+    {
+        CFRuntimeSetObjectAsConstant( CFNotificationCenterDarwin );
+    }
+}
+
+void CFNotificationCenterCreateDistributed( void )
+{
+    CFNotificationCenterDistributed = CFNotificationCenterCreate( NULL );
+    
+    if( CFNotificationCenterDistributed )
+    {
+        CFRuntimeSetObjectAsConstant( CFNotificationCenterDistributed );
+    }
+}
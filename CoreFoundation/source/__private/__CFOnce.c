@@ -0,0 +1,72 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CFOnce.c
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <CoreFoundation/__private/__CFOnce.h>
+#include <CoreFoundation/__private/__CFAtomic.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+void CFOnce( CFOnceToken * once, void ( * func )( void ) )
+{
+    if( once == NULL || func == NULL )
+    {
+        return;
+    }
+    
+    if( CFAtomicLoadAcquire( once ) == CF_ONCE_DONE )
+    {
+        return;
+    }
+    
+    if( CFAtomicCompareAndSwap( CF_ONCE_INIT, CF_ONCE_RUNNING, once ) )
+    {
+        func();
+        CFAtomicStoreRelease( CF_ONCE_DONE, once );
+        
+        return;
+    }
+    
+    while( CFAtomicLoadAcquire( once ) != CF_ONCE_DONE )
+    {
+        #ifdef _WIN32
+        
+        Sleep( 0 );
+        
+        #else
+        
+        sleep( 0 );
+        
+        #endif
+    }
+}
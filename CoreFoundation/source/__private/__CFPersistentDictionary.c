@@ -0,0 +1,1039 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        CFPersistentDictionary.c
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ */
+
+#include <CoreFoundation/__private/__CFPersistentDictionary.h>
+#include <CoreFoundation/__private/__CFDictionary.h>
+#include <CoreFoundation/__private/__CFAtomic.h>
+#include <string.h>
+
+#if defined( _WIN32 )
+#include <intrin.h>
+#endif
+
+CFTypeID       CFPersistentDictionaryTypeID = 0;
+CFRuntimeClass CFPersistentDictionaryClass  =
+{
+    "CFPersistentDictionary",
+    sizeof( struct CFPersistentDictionary ),
+    NULL,
+    ( void ( * )( CFTypeRef ) )CFPersistentDictionaryDestruct,
+    NULL,
+    ( bool ( * )( CFTypeRef, CFTypeRef ) )CFPersistentDictionaryEquals,
+    ( CFStringRef ( * )( CFTypeRef ) )CFPersistentDictionaryCopyDescription
+};
+
+void CFPersistentDictionaryInitialize( void )
+{
+    CFPersistentDictionaryTypeID = CFRuntimeRegisterClass( &CFPersistentDictionaryClass );
+}
+
+void CFPersistentDictionaryDestruct( CFPersistentDictionaryRef d )
+{
+    CFPersistentDictionaryNodeRelease( d, d->_root );
+}
+
+bool CFPersistentDictionaryEquals( CFPersistentDictionaryRef d1, CFPersistentDictionaryRef d2 )
+{
+    if( d1 == d2 || d1->_root == d2->_root )
+    {
+        return true;
+    }
+    
+    if( d1->_count != d2->_count )
+    {
+        return false;
+    }
+    
+    return CFPersistentDictionaryNodeContainedIn( d1, d1->_root, d2 );
+}
+
+CFStringRef CFPersistentDictionaryCopyDescription( CFPersistentDictionaryRef d )
+{
+    return CFStringCreateWithFormat
+    (
+        NULL,
+        NULL,
+        CFSTR( "{ count = %lu }" ),
+        d->_count
+    );
+}
+
+struct CFPersistentDictionary * CFPersistentDictionaryCreateEmpty( CFAllocatorRef allocator, const CFDictionaryKeyCallBacks * keyCallBacks, const CFDictionaryValueCallBacks * valueCallBacks )
+{
+    struct CFPersistentDictionary * o;
+    
+    o = ( struct CFPersistentDictionary * )CFRuntimeCreateInstance( allocator, CFPersistentDictionaryTypeID );
+    
+    if( o == NULL )
+    {
+        return NULL;
+    }
+    
+    if( keyCallBacks )
+    {
+        o->_keyCallbacks = *( keyCallBacks );
+    }
+    
+    if( valueCallBacks )
+    {
+        o->_valueCallbacks = *( valueCallBacks );
+    }
+    
+    return o;
+}
+
+CFHashCode CFPersistentDictionaryHashKey( CFPersistentDictionaryRef d, const void * key )
+{
+    /* Same hashes as CFDictionary, so entries can be exchanged with their hash */
+    if( d->_keyCallbacks.hash )
+    {
+        return CFDictionaryMixHash( d->_keyCallbacks.hash( key ) );
+    }
+    
+    return CFDictionaryMixHash( ( CFHashCode )( uintptr_t )key );
+}
+
+bool CFPersistentDictionaryKeysEqual( CFPersistentDictionaryRef d, const void * key1, const void * key2 )
+{
+    if( key1 == key2 )
+    {
+        return true;
+    }
+    
+    return d->_keyCallbacks.equal && d->_keyCallbacks.equal( key1, key2 );
+}
+
+CFIndex CFPersistentDictionaryPopCount( uint32_t map )
+{
+    #if defined( _WIN32 )
+    
+    return ( CFIndex )__popcnt( map );
+    
+    #elif defined( __GNUC__ ) || defined( __clang__ )
+    
+    return __builtin_popcount( map );
+    
+    #else
+    
+    map = map - ( ( map >> 1 ) & 0x55555555 );
+    map = ( map & 0x33333333 ) + ( ( map >> 2 ) & 0x33333333 );
+    map = ( map + ( map >> 4 ) ) & 0x0F0F0F0F;
+    
+    return ( CFIndex )( ( map * 0x01010101 ) >> 24 );
+    
+    #endif
+}
+
+CFIndex CFPersistentDictionaryNodeEntryCount( const struct CFPersistentDictionaryNode * node )
+{
+    if( node->collisions )
+    {
+        return node->collisions;
+    }
+    
+    return CFPersistentDictionaryPopCount( node->dataMap );
+}
+
+CFIndex CFPersistentDictionaryNodeChildCount( const struct CFPersistentDictionaryNode * node )
+{
+    return CFPersistentDictionaryPopCount( node->nodeMap );
+}
+
+struct CFPersistentDictionaryEntry * CFPersistentDictionaryNodeEntries( const struct CFPersistentDictionaryNode * node )
+{
+    return ( struct CFPersistentDictionaryEntry * )( ( const void * )( node + 1 ) );
+}
+
+struct CFPersistentDictionaryNode ** CFPersistentDictionaryNodeChildren( const struct CFPersistentDictionaryNode * node )
+{
+    return ( struct CFPersistentDictionaryNode ** )( ( void * )( CFPersistentDictionaryNodeEntries( node ) + CFPersistentDictionaryNodeEntryCount( node ) ) );
+}
+
+struct CFPersistentDictionaryNode * CFPersistentDictionaryNodeCreate( CFPersistentDictionaryRef d, CFIndex entryCount, CFIndex childCount )
+{
+    struct CFPersistentDictionaryNode * node;
+    
+    node = CFAllocatorAllocate
+    (
+        CFGetAllocator( d ),
+        ( CFIndex )sizeof( struct CFPersistentDictionaryNode )
+      + entryCount * ( CFIndex )sizeof( struct CFPersistentDictionaryEntry )
+      + childCount * ( CFIndex )sizeof( struct CFPersistentDictionaryNode * ),
+        0
+    );
+    
+    if( node == NULL )
+    {
+        return NULL;
+    }
+    
+    node->rc         = 1;
+    node->dataMap    = 0;
+    node->nodeMap    = 0;
+    node->collisions = 0;
+    
+    return node;
+}
+
+struct CFPersistentDictionaryNode * CFPersistentDictionaryNodeRetain( struct CFPersistentDictionaryNode * node )
+{
+    if( node )
+    {
+        CFAtomicIncrement( &( node->rc ) );
+    }
+    
+    return node;
+}
+
+void CFPersistentDictionaryNodeRelease( CFPersistentDictionaryRef d, struct CFPersistentDictionaryNode * node )
+{
+    CFIndex                              i;
+    CFIndex                              n;
+    struct CFPersistentDictionaryEntry * entries;
+    struct CFPersistentDictionaryNode ** children;
+    
+    if( node == NULL || CFAtomicDecrement( &( node->rc ) ) > 0 )
+    {
+        return;
+    }
+    
+    entries  = CFPersistentDictionaryNodeEntries( node );
+    children = CFPersistentDictionaryNodeChildren( node );
+    
+    for( i = 0, n = CFPersistentDictionaryNodeEntryCount( node ); i < n; i++ )
+    {
+        if( d->_keyCallbacks.release )
+        {
+            d->_keyCallbacks.release( CFGetAllocator( d ), entries[ i ].key );
+        }
+        
+        if( d->_valueCallbacks.release )
+        {
+            d->_valueCallbacks.release( CFGetAllocator( d ), entries[ i ].value );
+        }
+    }
+    
+    for( i = 0, n = CFPersistentDictionaryNodeChildCount( node ); i < n; i++ )
+    {
+        CFPersistentDictionaryNodeRelease( d, children[ i ] );
+    }
+    
+    CFAllocatorDeallocate( CFGetAllocator( d ), node );
+}
+
+void CFPersistentDictionaryNodeRetainContents( CFPersistentDictionaryRef d, struct CFPersistentDictionaryNode * node )
+{
+    CFIndex                              i;
+    CFIndex                              n;
+    struct CFPersistentDictionaryEntry * entries;
+    struct CFPersistentDictionaryNode ** children;
+    
+    /*
+     * New nodes are filled with the entries and children they share with
+     * other nodes, which are retained here. NULL children are placeholders
+     * for new nodes, already owned by the node.
+     */
+    entries  = CFPersistentDictionaryNodeEntries( node );
+    children = CFPersistentDictionaryNodeChildren( node );
+    
+    for( i = 0, n = CFPersistentDictionaryNodeEntryCount( node ); i < n; i++ )
+    {
+        if( d->_keyCallbacks.retain )
+        {
+            entries[ i ].key = d->_keyCallbacks.retain( CFGetAllocator( d ), entries[ i ].key );
+        }
+        
+        if( d->_valueCallbacks.retain )
+        {
+            entries[ i ].value = d->_valueCallbacks.retain( CFGetAllocator( d ), entries[ i ].value );
+        }
+    }
+    
+    for( i = 0, n = CFPersistentDictionaryNodeChildCount( node ); i < n; i++ )
+    {
+        CFPersistentDictionaryNodeRetain( children[ i ] );
+    }
+}
+
+struct CFPersistentDictionaryEntry * CFPersistentDictionaryNodeFind( CFPersistentDictionaryRef d, const struct CFPersistentDictionaryNode * node, const void * key, CFHashCode h )
+{
+    CFIndex                              shift;
+    CFIndex                              i;
+    uint32_t                             bit;
+    struct CFPersistentDictionaryEntry * entry;
+    
+    for( shift = 0; node != NULL; shift += CF_PERSISTENT_DICTIONARY_BITS )
+    {
+        if( node->collisions )
+        {
+            for( i = 0; i < node->collisions; i++ )
+            {
+                entry = &( CFPersistentDictionaryNodeEntries( node )[ i ] );
+                
+                if( entry->hash == h && CFPersistentDictionaryKeysEqual( d, entry->key, key ) )
+                {
+                    return entry;
+                }
+            }
+            
+            return NULL;
+        }
+        
+        bit = ( uint32_t )1 << CF_PERSISTENT_DICTIONARY_INDEX( h, shift );
+        
+        if( node->dataMap & bit )
+        {
+            entry = &( CFPersistentDictionaryNodeEntries( node )[ CFPersistentDictionaryPopCount( node->dataMap & ( bit - 1 ) ) ] );
+            
+            return ( entry->hash == h && CFPersistentDictionaryKeysEqual( d, entry->key, key ) ) ? entry : NULL;
+        }
+        
+        if( ( node->nodeMap & bit ) == 0 )
+        {
+            return NULL;
+        }
+        
+        node = CFPersistentDictionaryNodeChildren( node )[ CFPersistentDictionaryPopCount( node->nodeMap & ( bit - 1 ) ) ];
+    }
+    
+    return NULL;
+}
+
+struct CFPersistentDictionaryNode * CFPersistentDictionaryNodeMerge( CFPersistentDictionaryRef d, const struct CFPersistentDictionaryEntry * entry1, const struct CFPersistentDictionaryEntry * entry2, CFIndex shift )
+{
+    struct CFPersistentDictionaryNode * node;
+    struct CFPersistentDictionaryNode * child;
+    uint32_t                            index1;
+    uint32_t                            index2;
+    
+    if( shift >= CF_PERSISTENT_DICTIONARY_MAX_SHIFT )
+    {
+        node = CFPersistentDictionaryNodeCreate( d, 2, 0 );
+        
+        if( node == NULL )
+        {
+            return NULL;
+        }
+        
+        node->collisions                                = 2;
+        CFPersistentDictionaryNodeEntries( node )[ 0 ] = *( entry1 );
+        CFPersistentDictionaryNodeEntries( node )[ 1 ] = *( entry2 );
+        
+        CFPersistentDictionaryNodeRetainContents( d, node );
+        
+        return node;
+    }
+    
+    index1 = CF_PERSISTENT_DICTIONARY_INDEX( entry1->hash, shift );
+    index2 = CF_PERSISTENT_DICTIONARY_INDEX( entry2->hash, shift );
+    
+    if( index1 != index2 )
+    {
+        node = CFPersistentDictionaryNodeCreate( d, 2, 0 );
+        
+        if( node == NULL )
+        {
+            return NULL;
+        }
+        
+        node->dataMap                                                  = ( ( uint32_t )1 << index1 ) | ( ( uint32_t )1 << index2 );
+        CFPersistentDictionaryNodeEntries( node )[ ( index1 < index2 ) ? 0 : 1 ] = *( entry1 );
+        CFPersistentDictionaryNodeEntries( node )[ ( index1 < index2 ) ? 1 : 0 ] = *( entry2 );
+        
+        CFPersistentDictionaryNodeRetainContents( d, node );
+        
+        return node;
+    }
+    
+    child = CFPersistentDictionaryNodeMerge( d, entry1, entry2, shift + CF_PERSISTENT_DICTIONARY_BITS );
+    
+    if( child == NULL )
+    {
+        return NULL;
+    }
+    
+    node = CFPersistentDictionaryNodeCreate( d, 0, 1 );
+    
+    if( node == NULL )
+    {
+        CFPersistentDictionaryNodeRelease( d, child );
+        
+        return NULL;
+    }
+    
+    node->nodeMap                                  = ( uint32_t )1 << index1;
+    CFPersistentDictionaryNodeChildren( node )[ 0 ] = child;
+    
+    return node;
+}
+
+bool CFPersistentDictionaryNodeSet( CFPersistentDictionaryRef d, struct CFPersistentDictionaryNode * node, CFIndex shift, const struct CFPersistentDictionaryEntry * entry, struct CFPersistentDictionaryNode ** result, bool * added )
+{
+    struct CFPersistentDictionaryNode  * o;
+    struct CFPersistentDictionaryNode  * child;
+    struct CFPersistentDictionaryEntry * entries;
+    struct CFPersistentDictionaryNode ** children;
+    CFIndex                              n;
+    CFIndex                              c;
+    CFIndex                              i;
+    CFIndex                              j;
+    uint32_t                             bit;
+    
+    *( result ) = NULL;
+    *( added )  = false;
+    
+    if( node == NULL )
+    {
+        if( ( o = CFPersistentDictionaryNodeCreate( d, 1, 0 ) ) == NULL )
+        {
+            return false;
+        }
+        
+        o->dataMap                                  = ( uint32_t )1 << CF_PERSISTENT_DICTIONARY_INDEX( entry->hash, shift );
+        CFPersistentDictionaryNodeEntries( o )[ 0 ] = *( entry );
+        
+        CFPersistentDictionaryNodeRetainContents( d, o );
+        
+        *( result ) = o;
+        *( added )  = true;
+        
+        return true;
+    }
+    
+    entries  = CFPersistentDictionaryNodeEntries( node );
+    children = CFPersistentDictionaryNodeChildren( node );
+    n        = CFPersistentDictionaryNodeEntryCount( node );
+    c        = CFPersistentDictionaryNodeChildCount( node );
+    
+    if( node->collisions )
+    {
+        for( i = 0; i < n; i++ )
+        {
+            if( CFPersistentDictionaryKeysEqual( d, entries[ i ].key, entry->key ) )
+            {
+                break;
+            }
+        }
+        
+        if( i < n && entries[ i ].value == entry->value )
+        {
+            *( result ) = CFPersistentDictionaryNodeRetain( node );
+            
+            return true;
+        }
+        
+        if( ( o = CFPersistentDictionaryNodeCreate( d, ( i < n ) ? n : n + 1, 0 ) ) == NULL )
+        {
+            return false;
+        }
+        
+        o->collisions = ( i < n ) ? n : n + 1;
+        
+        memcpy( CFPersistentDictionaryNodeEntries( o ), entries, ( size_t )n * sizeof( struct CFPersistentDictionaryEntry ) );
+        
+        if( i < n )
+        {
+            CFPersistentDictionaryNodeEntries( o )[ i ].value = entry->value;
+        }
+        else
+        {
+            CFPersistentDictionaryNodeEntries( o )[ n ] = *( entry );
+            *( added )                                  = true;
+        }
+        
+        CFPersistentDictionaryNodeRetainContents( d, o );
+        
+        *( result ) = o;
+        
+        return true;
+    }
+    
+    bit = ( uint32_t )1 << CF_PERSISTENT_DICTIONARY_INDEX( entry->hash, shift );
+    i   = CFPersistentDictionaryPopCount( node->dataMap & ( bit - 1 ) );
+    j   = CFPersistentDictionaryPopCount( node->nodeMap & ( bit - 1 ) );
+    
+    if( node->dataMap & bit )
+    {
+        if( entries[ i ].hash == entry->hash && CFPersistentDictionaryKeysEqual( d, entries[ i ].key, entry->key ) )
+        {
+            if( entries[ i ].value == entry->value )
+            {
+                *( result ) = CFPersistentDictionaryNodeRetain( node );
+                
+                return true;
+            }
+            
+            /* Same layout, with the existing key and the new value */
+            if( ( o = CFPersistentDictionaryNodeCreate( d, n, c ) ) == NULL )
+            {
+                return false;
+            }
+            
+            o->dataMap = node->dataMap;
+            o->nodeMap = node->nodeMap;
+            
+            memcpy( CFPersistentDictionaryNodeEntries( o ), entries, ( size_t )n * sizeof( struct CFPersistentDictionaryEntry ) );
+            memcpy( CFPersistentDictionaryNodeChildren( o ), children, ( size_t )c * sizeof( struct CFPersistentDictionaryNode * ) );
+            
+            CFPersistentDictionaryNodeEntries( o )[ i ].value = entry->value;
+            
+            CFPersistentDictionaryNodeRetainContents( d, o );
+            
+            *( result ) = o;
+            
+            return true;
+        }
+        
+        /* Both entries are moved to a new child node */
+        if( ( child = CFPersistentDictionaryNodeMerge( d, &( entries[ i ] ), entry, shift + CF_PERSISTENT_DICTIONARY_BITS ) ) == NULL )
+        {
+            return false;
+        }
+        
+        if( ( o = CFPersistentDictionaryNodeCreate( d, n - 1, c + 1 ) ) == NULL )
+        {
+            CFPersistentDictionaryNodeRelease( d, child );
+            
+            return false;
+        }
+        
+        o->dataMap = node->dataMap & ~bit;
+        o->nodeMap = node->nodeMap | bit;
+        
+        memcpy( CFPersistentDictionaryNodeEntries( o ), entries, ( size_t )i * sizeof( struct CFPersistentDictionaryEntry ) );
+        memcpy( CFPersistentDictionaryNodeEntries( o ) + i, entries + i + 1, ( size_t )( n - i - 1 ) * sizeof( struct CFPersistentDictionaryEntry ) );
+        memcpy( CFPersistentDictionaryNodeChildren( o ), children, ( size_t )j * sizeof( struct CFPersistentDictionaryNode * ) );
+        memcpy( CFPersistentDictionaryNodeChildren( o ) + j + 1, children + j, ( size_t )( c - j ) * sizeof( struct CFPersistentDictionaryNode * ) );
+        
+        CFPersistentDictionaryNodeChildren( o )[ j ] = NULL;
+        
+        CFPersistentDictionaryNodeRetainContents( d, o );
+        
+        CFPersistentDictionaryNodeChildren( o )[ j ] = child;
+        *( result )                                  = o;
+        *( added )                                   = true;
+        
+        return true;
+    }
+    
+    if( node->nodeMap & bit )
+    {
+        if( CFPersistentDictionaryNodeSet( d, children[ j ], shift + CF_PERSISTENT_DICTIONARY_BITS, entry, &child, added ) == false )
+        {
+            return false;
+        }
+        
+        if( child == children[ j ] )
+        {
+            CFPersistentDictionaryNodeRelease( d, child );
+            
+            *( result ) = CFPersistentDictionaryNodeRetain( node );
+            
+            return true;
+        }
+        
+        if( ( o = CFPersistentDictionaryNodeCreate( d, n, c ) ) == NULL )
+        {
+            CFPersistentDictionaryNodeRelease( d, child );
+            
+            *( added ) = false;
+            
+            return false;
+        }
+        
+        o->dataMap = node->dataMap;
+        o->nodeMap = node->nodeMap;
+        
+        memcpy( CFPersistentDictionaryNodeEntries( o ), entries, ( size_t )n * sizeof( struct CFPersistentDictionaryEntry ) );
+        memcpy( CFPersistentDictionaryNodeChildren( o ), children, ( size_t )c * sizeof( struct CFPersistentDictionaryNode * ) );
+        
+        CFPersistentDictionaryNodeChildren( o )[ j ] = NULL;
+        
+        CFPersistentDictionaryNodeRetainContents( d, o );
+        
+        CFPersistentDictionaryNodeChildren( o )[ j ] = child;
+        *( result )                                  = o;
+        
+        return true;
+    }
+    
+    if( ( o = CFPersistentDictionaryNodeCreate( d, n + 1, c ) ) == NULL )
+    {
+        return false;
+    }
+    
+    o->dataMap = node->dataMap | bit;
+    o->nodeMap = node->nodeMap;
+    
+    memcpy( CFPersistentDictionaryNodeEntries( o ), entries, ( size_t )i * sizeof( struct CFPersistentDictionaryEntry ) );
+    memcpy( CFPersistentDictionaryNodeEntries( o ) + i + 1, entries + i, ( size_t )( n - i ) * sizeof( struct CFPersistentDictionaryEntry ) );
+    memcpy( CFPersistentDictionaryNodeChildren( o ), children, ( size_t )c * sizeof( struct CFPersistentDictionaryNode * ) );
+    
+    CFPersistentDictionaryNodeEntries( o )[ i ] = *( entry );
+    
+    CFPersistentDictionaryNodeRetainContents( d, o );
+    
+    *( result ) = o;
+    *( added )  = true;
+    
+    return true;
+}
+
+bool CFPersistentDictionaryNodeBuild( CFPersistentDictionaryRef d, struct CFPersistentDictionaryEntry * entries, struct CFPersistentDictionaryEntry * scratch, CFIndex count, CFIndex shift, struct CFPersistentDictionaryNode ** result, CFIndex * added )
+{
+    struct CFPersistentDictionaryNode * o;
+    struct CFPersistentDictionaryNode * nodes[ 32 ];
+    CFIndex                             counts[ 32 ];
+    CFIndex                             offsets[ 32 ];
+    CFIndex                             i;
+    CFIndex                             j;
+    CFIndex                             n;
+    CFIndex                             c;
+    uint32_t                            index;
+    
+    *( result ) = NULL;
+    
+    if( count == 0 )
+    {
+        return true;
+    }
+    
+    if( shift >= CF_PERSISTENT_DICTIONARY_MAX_SHIFT )
+    {
+        /* Equal keys are only found here, with the same hash - The last value wins */
+        for( i = 0, n = 0; i < count; i++ )
+        {
+            for( j = 0; j < n; j++ )
+            {
+                if( CFPersistentDictionaryKeysEqual( d, entries[ j ].key, entries[ i ].key ) )
+                {
+                    break;
+                }
+            }
+            
+            if( j < n )
+            {
+                entries[ j ].value = entries[ i ].value;
+            }
+            else
+            {
+                entries[ n++ ] = entries[ i ];
+            }
+        }
+        
+        if( ( o = CFPersistentDictionaryNodeCreate( d, n, 0 ) ) == NULL )
+        {
+            return false;
+        }
+        
+        o->collisions = n;
+        
+        memcpy( CFPersistentDictionaryNodeEntries( o ), entries, ( size_t )n * sizeof( struct CFPersistentDictionaryEntry ) );
+        
+        CFPersistentDictionaryNodeRetainContents( d, o );
+        
+        *( result ) = o;
+        *( added ) += n;
+        
+        return true;
+    }
+    
+    /*
+     * Stable counting sort of the entries by index, into scratch. Each range
+     * of more than one entry becomes a child node, built with entries as its
+     * scratch space.
+     */
+    memset( counts, 0, sizeof( counts ) );
+    memset( nodes,  0, sizeof( nodes ) );
+    
+    for( i = 0; i < count; i++ )
+    {
+        counts[ CF_PERSISTENT_DICTIONARY_INDEX( entries[ i ].hash, shift ) ]++;
+    }
+    
+    for( offsets[ 0 ] = 0, index = 1; index < 32; index++ )
+    {
+        offsets[ index ] = offsets[ index - 1 ] + counts[ index - 1 ];
+    }
+    
+    for( i = 0; i < count; i++ )
+    {
+        index                        = CF_PERSISTENT_DICTIONARY_INDEX( entries[ i ].hash, shift );
+        scratch[ offsets[ index ]++ ] = entries[ i ];
+    }
+    
+    for( n = 0, c = 0, index = 0; index < 32; index++ )
+    {
+        offsets[ index ] -= counts[ index ];
+        
+        if( counts[ index ] > 1 )
+        {
+            if( CFPersistentDictionaryNodeBuild( d, scratch + offsets[ index ], entries + offsets[ index ], counts[ index ], shift + CF_PERSISTENT_DICTIONARY_BITS, &( nodes[ index ] ), added ) == false )
+            {
+                for( index = 0; index < 32; index++ )
+                {
+                    CFPersistentDictionaryNodeRelease( d, nodes[ index ] );
+                }
+                
+                return false;
+            }
+            
+            /* Single entries, after removing equal keys, are stored here */
+            if( CFPersistentDictionaryNodeEntryCount( nodes[ index ] ) == 1 && CFPersistentDictionaryNodeChildCount( nodes[ index ] ) == 0 )
+            {
+                scratch[ offsets[ index ] ] = CFPersistentDictionaryNodeEntries( nodes[ index ] )[ 0 ];
+                counts[ index ]             = 1;
+            }
+            else
+            {
+                c++;
+                
+                continue;
+            }
+        }
+        else if( counts[ index ] == 1 )
+        {
+            ( *( added ) )++;
+        }
+        
+        n += counts[ index ];
+    }
+    
+    if( ( o = CFPersistentDictionaryNodeCreate( d, n, c ) ) == NULL )
+    {
+        for( index = 0; index < 32; index++ )
+        {
+            CFPersistentDictionaryNodeRelease( d, nodes[ index ] );
+        }
+        
+        return false;
+    }
+    
+    for( index = 0; index < 32; index++ )
+    {
+        if( counts[ index ] == 1 )
+        {
+            o->dataMap |= ( uint32_t )1 << index;
+        }
+        else if( counts[ index ] > 1 )
+        {
+            o->nodeMap |= ( uint32_t )1 << index;
+        }
+    }
+    
+    for( i = 0, j = 0, index = 0; index < 32; index++ )
+    {
+        if( counts[ index ] == 1 )
+        {
+            CFPersistentDictionaryNodeEntries( o )[ i++ ] = scratch[ offsets[ index ] ];
+        }
+        else if( counts[ index ] > 1 )
+        {
+            CFPersistentDictionaryNodeChildren( o )[ j++ ] = NULL;
+        }
+    }
+    
+    CFPersistentDictionaryNodeRetainContents( d, o );
+    
+    for( j = 0, index = 0; index < 32; index++ )
+    {
+        if( counts[ index ] > 1 )
+        {
+            CFPersistentDictionaryNodeChildren( o )[ j++ ] = nodes[ index ];
+        }
+        else
+        {
+            CFPersistentDictionaryNodeRelease( d, nodes[ index ] );
+        }
+    }
+    
+    *( result ) = o;
+    
+    return true;
+}
+
+bool CFPersistentDictionaryNodeRemove( CFPersistentDictionaryRef d, struct CFPersistentDictionaryNode * node, CFIndex shift, const void * key, CFHashCode h, struct CFPersistentDictionaryNode ** result )
+{
+    struct CFPersistentDictionaryNode  * o;
+    struct CFPersistentDictionaryNode  * child;
+    struct CFPersistentDictionaryEntry * entries;
+    struct CFPersistentDictionaryNode ** children;
+    CFIndex                              n;
+    CFIndex                              c;
+    CFIndex                              i;
+    CFIndex                              j;
+    uint32_t                             bit;
+    
+    /* Unchanged nodes are returned retained */
+    *( result ) = CFPersistentDictionaryNodeRetain( node );
+    
+    if( node == NULL )
+    {
+        return true;
+    }
+    
+    entries  = CFPersistentDictionaryNodeEntries( node );
+    children = CFPersistentDictionaryNodeChildren( node );
+    n        = CFPersistentDictionaryNodeEntryCount( node );
+    c        = CFPersistentDictionaryNodeChildCount( node );
+    bit      = ( node->collisions ) ? 0 : ( uint32_t )1 << CF_PERSISTENT_DICTIONARY_INDEX( h, shift );
+    
+    if( node->collisions || ( node->dataMap & bit ) )
+    {
+        if( node->collisions )
+        {
+            for( i = 0; i < n; i++ )
+            {
+                if( CFPersistentDictionaryKeysEqual( d, entries[ i ].key, key ) )
+                {
+                    break;
+                }
+            }
+        }
+        else
+        {
+            i = CFPersistentDictionaryPopCount( node->dataMap & ( bit - 1 ) );
+            
+            if( entries[ i ].hash != h || CFPersistentDictionaryKeysEqual( d, entries[ i ].key, key ) == false )
+            {
+                i = n;
+            }
+        }
+        
+        if( i == n )
+        {
+            return true;
+        }
+        
+        CFPersistentDictionaryNodeRelease( d, node );
+        
+        if( n == 1 && c == 0 )
+        {
+            *( result ) = NULL;
+            
+            return true;
+        }
+        
+        if( ( o = CFPersistentDictionaryNodeCreate( d, n - 1, c ) ) == NULL )
+        {
+            *( result ) = NULL;
+            
+            return false;
+        }
+        
+        o->dataMap    = node->dataMap & ~bit;
+        o->nodeMap    = node->nodeMap;
+        o->collisions = ( node->collisions ) ? n - 1 : 0;
+        
+        memcpy( CFPersistentDictionaryNodeEntries( o ), entries, ( size_t )i * sizeof( struct CFPersistentDictionaryEntry ) );
+        memcpy( CFPersistentDictionaryNodeEntries( o ) + i, entries + i + 1, ( size_t )( n - i - 1 ) * sizeof( struct CFPersistentDictionaryEntry ) );
+        memcpy( CFPersistentDictionaryNodeChildren( o ), children, ( size_t )c * sizeof( struct CFPersistentDictionaryNode * ) );
+        
+        CFPersistentDictionaryNodeRetainContents( d, o );
+        
+        *( result ) = o;
+        
+        return true;
+    }
+    
+    if( ( node->nodeMap & bit ) == 0 )
+    {
+        return true;
+    }
+    
+    i = CFPersistentDictionaryPopCount( node->dataMap & ( bit - 1 ) );
+    j = CFPersistentDictionaryPopCount( node->nodeMap & ( bit - 1 ) );
+    
+    if( CFPersistentDictionaryNodeRemove( d, children[ j ], shift + CF_PERSISTENT_DICTIONARY_BITS, key, h, &child ) == false )
+    {
+        CFPersistentDictionaryNodeRelease( d, node );
+        
+        *( result ) = NULL;
+        
+        return false;
+    }
+    
+    if( child == children[ j ] )
+    {
+        CFPersistentDictionaryNodeRelease( d, child );
+        
+        return true;
+    }
+    
+    CFPersistentDictionaryNodeRelease( d, node );
+    
+    *( result ) = NULL;
+    
+    if( child != NULL && ( CFPersistentDictionaryNodeEntryCount( child ) > 1 || CFPersistentDictionaryNodeChildCount( child ) > 0 ) )
+    {
+        if( ( o = CFPersistentDictionaryNodeCreate( d, n, c ) ) == NULL )
+        {
+            CFPersistentDictionaryNodeRelease( d, child );
+            
+            return false;
+        }
+        
+        o->dataMap = node->dataMap;
+        o->nodeMap = node->nodeMap;
+        
+        memcpy( CFPersistentDictionaryNodeEntries( o ), entries, ( size_t )n * sizeof( struct CFPersistentDictionaryEntry ) );
+        memcpy( CFPersistentDictionaryNodeChildren( o ), children, ( size_t )c * sizeof( struct CFPersistentDictionaryNode * ) );
+        
+        CFPersistentDictionaryNodeChildren( o )[ j ] = NULL;
+        
+        CFPersistentDictionaryNodeRetainContents( d, o );
+        
+        CFPersistentDictionaryNodeChildren( o )[ j ] = child;
+        *( result )                                  = o;
+        
+        return true;
+    }
+    
+    /* The child node is left with a single entry, which moves to this node */
+    if( ( o = CFPersistentDictionaryNodeCreate( d, ( child ) ? n + 1 : n, c - 1 ) ) == NULL )
+    {
+        CFPersistentDictionaryNodeRelease( d, child );
+        
+        return false;
+    }
+    
+    o->dataMap = ( child ) ? node->dataMap | bit : node->dataMap;
+    o->nodeMap = node->nodeMap & ~bit;
+    
+    memcpy( CFPersistentDictionaryNodeEntries( o ), entries, ( size_t )i * sizeof( struct CFPersistentDictionaryEntry ) );
+    
+    if( child )
+    {
+        CFPersistentDictionaryNodeEntries( o )[ i ] = CFPersistentDictionaryNodeEntries( child )[ 0 ];
+        
+        memcpy( CFPersistentDictionaryNodeEntries( o ) + i + 1, entries + i, ( size_t )( n - i ) * sizeof( struct CFPersistentDictionaryEntry ) );
+    }
+    else
+    {
+        memcpy( CFPersistentDictionaryNodeEntries( o ) + i, entries + i, ( size_t )( n - i ) * sizeof( struct CFPersistentDictionaryEntry ) );
+    }
+    
+    memcpy( CFPersistentDictionaryNodeChildren( o ), children, ( size_t )j * sizeof( struct CFPersistentDictionaryNode * ) );
+    memcpy( CFPersistentDictionaryNodeChildren( o ) + j, children + j + 1, ( size_t )( c - j - 1 ) * sizeof( struct CFPersistentDictionaryNode * ) );
+    
+    CFPersistentDictionaryNodeRetainContents( d, o );
+    CFPersistentDictionaryNodeRelease( d, child );
+    
+    *( result ) = o;
+    
+    return true;
+}
+
+void CFPersistentDictionaryNodeApply( const struct CFPersistentDictionaryNode * node, CFDictionaryApplierFunction applier, void * context )
+{
+    CFIndex                              i;
+    CFIndex                              n;
+    struct CFPersistentDictionaryEntry * entries;
+    
+    if( node == NULL )
+    {
+        return;
+    }
+    
+    entries = CFPersistentDictionaryNodeEntries( node );
+    
+    for( i = 0, n = CFPersistentDictionaryNodeEntryCount( node ); i < n; i++ )
+    {
+        applier( entries[ i ].key, entries[ i ].value, context );
+    }
+    
+    for( i = 0, n = CFPersistentDictionaryNodeChildCount( node ); i < n; i++ )
+    {
+        CFPersistentDictionaryNodeApply( CFPersistentDictionaryNodeChildren( node )[ i ], applier, context );
+    }
+}
+
+void CFPersistentDictionaryNodeGetEntries( const struct CFPersistentDictionaryNode * node, struct CFPersistentDictionaryEntry * entries, CFIndex * count )
+{
+    CFIndex i;
+    CFIndex n;
+    
+    if( node == NULL )
+    {
+        return;
+    }
+    
+    n = CFPersistentDictionaryNodeEntryCount( node );
+    
+    memcpy( entries + *( count ), CFPersistentDictionaryNodeEntries( node ), ( size_t )n * sizeof( struct CFPersistentDictionaryEntry ) );
+    
+    *( count ) += n;
+    
+    for( i = 0, n = CFPersistentDictionaryNodeChildCount( node ); i < n; i++ )
+    {
+        CFPersistentDictionaryNodeGetEntries( CFPersistentDictionaryNodeChildren( node )[ i ], entries, count );
+    }
+}
+
+bool CFPersistentDictionaryNodeContainedIn( CFPersistentDictionaryRef d, const struct CFPersistentDictionaryNode * node, CFPersistentDictionaryRef other )
+{
+    CFIndex                              i;
+    CFIndex                              n;
+    struct CFPersistentDictionaryEntry * entries;
+    struct CFPersistentDictionaryEntry * entry;
+    bool                                 sameHash;
+    
+    if( node == NULL )
+    {
+        return true;
+    }
+    
+    entries  = CFPersistentDictionaryNodeEntries( node );
+    sameHash = d->_keyCallbacks.hash == other->_keyCallbacks.hash;
+    
+    for( i = 0, n = CFPersistentDictionaryNodeEntryCount( node ); i < n; i++ )
+    {
+        entry = CFPersistentDictionaryNodeFind( other, other->_root, entries[ i ].key, ( sameHash ) ? entries[ i ].hash : CFPersistentDictionaryHashKey( other, entries[ i ].key ) );
+        
+        if( entry == NULL )
+        {
+            return false;
+        }
+        
+        if( entry->value != entries[ i ].value && ( d->_valueCallbacks.equal == NULL || d->_valueCallbacks.equal( entries[ i ].value, entry->value ) == false ) )
+        {
+            return false;
+        }
+    }
+    
+    for( i = 0, n = CFPersistentDictionaryNodeChildCount( node ); i < n; i++ )
+    {
+        if( CFPersistentDictionaryNodeContainedIn( d, CFPersistentDictionaryNodeChildren( node )[ i ], other ) == false )
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
@@ -140,6 +140,11 @@ const char * CFRuntimeGetTypeIDName( CFTypeID typeID )
 }
 
 CFTypeRef CFRuntimeCreateInstance( CFAllocatorRef allocator, CFTypeID typeID )
+{
+    return CFRuntimeCreateInstanceWithExtraBytes( allocator, typeID, 0 );
+}
+
+CFTypeRef CFRuntimeCreateInstanceWithExtraBytes( CFAllocatorRef allocator, CFTypeID typeID, CFIndex extraBytes )
 {
     void * obj;
     
@@ -148,7 +153,7 @@ CFTypeRef CFRuntimeCreateInstance( CFAllocatorRef allocator, CFTypeID typeID )
         allocator = CFAllocatorGetDefault();
     }
     
-    obj = CFAllocatorAllocate( allocator, CFRuntimeGetInstanceSize( typeID ), 1 );
+    obj = CFAllocatorAllocate( allocator, CFRuntimeGetInstanceSize( typeID ) + extraBytes, 1 );
     
     CFRuntimeInitInstance( obj, typeID, allocator );
     
@@ -27,25 +27,49 @@
  * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
  */
 
+#if !defined( _WIN32 ) && !defined( __APPLE__ ) && !defined( _POSIX_C_SOURCE )
+#define _POSIX_C_SOURCE 199309L
+#endif
+
 #include <CoreFoundation/__private/__CFSpinLock.h>
 #include <CoreFoundation/__private/__CFAtomic.h>
 #include <stdlib.h>
 
-#ifdef _WIN32
+#if defined( _WIN32 )
 #include <Windows.h>
+#elif defined( __APPLE__ )
+#include <unistd.h>
+#include <mach/mach_time.h>
 #else
 #include <unistd.h>
+#include <time.h>
 #endif
 
+volatile CFIndex                CFSpinLockProfiling      = 0;
+CFSpinLockStatistics * volatile CFSpinLockStatisticsList = NULL;
+
 void CFSpinLockLock( CFSpinLock * lock )
 {
+    uint64_t start;
+    bool     contended;
+    
     if( lock == NULL )
     {
         return;
     }
     
-    while( CFAtomicCompareAndSwap( 0, 1, lock ) )
+    start     = 0;
+    contended = false;
+    
+    if( CFSpinLockProfiling && lock->statistics )
+    {
+        start = CFSpinLockGetTime();
+    }
+    
+    while( CFAtomicCompareAndSwap( 0, 1, &( lock->value ) ) == false )
     {
+        contended = true;
+        
         #ifdef _WIN32
         
         Sleep( 0 );
@@ -56,14 +80,106 @@ void CFSpinLockLock( CFSpinLock * lock )
         
         #endif
     }
+    
+    if( start == 0 )
+    {
+        return;
+    }
+    
+    lock->holdStart = CFSpinLockGetTime();
+    
+    CFSpinLockRegisterStatistics( lock->statistics );
+    CFAtomicIncrement64( &( lock->statistics->acquisitions ) );
+    
+    if( contended )
+    {
+        CFAtomicIncrement64( &( lock->statistics->contendedAcquisitions ) );
+        CFAtomicAdd64( ( int64_t )( lock->holdStart - start ), &( lock->statistics->waitTime ) );
+    }
 }
 
 void CFSpinLockUnlock( CFSpinLock * lock )
 {
+    int64_t hold;
+    int64_t max;
+    
     if( lock == NULL )
     {
         return;
     }
     
-    CFAtomicDecrement( lock );
+    if( lock->holdStart && lock->statistics )
+    {
+        hold            = ( int64_t )( CFSpinLockGetTime() - lock->holdStart );
+        lock->holdStart = 0;
+        
+        do
+        {
+            max = lock->statistics->maxHoldTime;
+            
+            if( hold <= max )
+            {
+                break;
+            }
+        }
+        while( CFAtomicCompareAndSwap64( max, hold, &( lock->statistics->maxHoldTime ) ) == false );
+    }
+    
+    CFAtomicStoreRelease( 0, &( lock->value ) );
+}
+
+uint64_t CFSpinLockGetTime( void )
+{
+    #if defined( _WIN32 )
+    
+    LARGE_INTEGER count;
+    LARGE_INTEGER frequency;
+    
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    
+    return ( uint64_t )( ( double )( count.QuadPart ) * ( 1000000000.0 / ( double )( frequency.QuadPart ) ) );
+    
+    #elif defined( __APPLE__ )
+    
+    static mach_timebase_info_data_t info;
+    
+    if( info.denom == 0 )
+    {
+        mach_timebase_info( &info );
+    }
+    
+    return ( mach_absolute_time() * info.numer ) / info.denom;
+    
+    #else
+    
+    struct timespec ts;
+    
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    
+    return ( uint64_t )( ts.tv_sec ) * 1000000000 + ( uint64_t )( ts.tv_nsec );
+    
+    #endif
+}
+
+void CFSpinLockRegisterStatistics( CFSpinLockStatistics * statistics )
+{
+    CFSpinLockStatistics * head;
+    
+    if( statistics == NULL || statistics->registered )
+    {
+        return;
+    }
+    
+    if( CFAtomicCompareAndSwap( 0, 1, &( statistics->registered ) ) == false )
+    {
+        return;
+    }
+    
+    do
+    {
+        head             = CFSpinLockStatisticsList;
+        statistics->next = head;
+    }
+    while( CFAtomicCompareAndSwapPointer( head, statistics, ( void * volatile * )&CFSpinLockStatisticsList ) == false );
 }
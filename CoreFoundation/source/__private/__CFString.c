@@ -28,6 +28,8 @@
  */
 
 #include <CoreFoundation/__private/__CFString.h>
+#include <CoreFoundation/__private/__CFDictionary.h>
+#include <CoreFoundation/__private/__CFAtomic.h>
 #include <string.h>
 
 CFTypeID       CFStringTypeID = 0;
@@ -42,9 +44,11 @@ CFRuntimeClass CFStringClass  =
     ( CFStringRef ( * )( CFTypeRef ) )CFStringCopyDescription
 };
 
-CFSpinLock    CFStringConstantStringsLock     = 0;
-CFIndex       CFStringConstantStringsCapacity = 0;
-CFStringRef * CFStringConstantStrings         = NULL;
+CFSpinLockStatistics CFStringUniquingLockStatistics = CF_SPIN_LOCK_STATISTICS_INIT( "CFString uniquing" );
+
+CFSpinLock                              CFStringUniquingLock   = CF_SPIN_LOCK_INIT( &CFStringUniquingLockStatistics );
+struct CFStringUniquingTable * volatile CFStringUniquedStrings = NULL;
+CFIndex                                 CFStringUniquedCount   = 0;
 
 void CFStringInitialize( void )
 {
@@ -53,7 +57,7 @@ void CFStringInitialize( void )
 
 void CFStringDestruct( CFStringRef str )
 {
-    if( str->_cStr )
+    if( str->_cStr && str->_cStr != CF_STRING_INLINE_BYTES( str ) )
     {
         CFAllocatorDeallocate( str->_allocator, ( void * )( str->_cStr ) );
     }
@@ -66,21 +70,45 @@ void CFStringDestruct( CFStringRef str )
 
 CFHashCode CFStringHash( CFStringRef str )
 {
-    CFHashCode            h;
-    unsigned char         c;
-    const unsigned char * cp;
+    CFHashCode h;
+    
+    if( str->_hashed )
+    {
+        return str->_hash;
+    }
     
     if( str->_cStr == NULL )
     {
         return ( CFHashCode )str;
     }
     
-    cp = ( const unsigned char * )( str->_cStr );
+    h = CFStringHashBytes( str->_cStr, str->_length );
+    
+    /*
+     * Immutable strings are hashed on creation, so an unhashed immutable
+     * string is a long CF_STRING_CONST_DECL literal in read-only memory.
+     */
+    if( str->_mutable )
+    {
+        ( ( struct CFString * )str )->_hash   = h;
+        ( ( struct CFString * )str )->_hashed = true;
+    }
+    
+    return h;
+}
+
+CFHashCode CFStringHashBytes( const char * bytes, CFIndex length )
+{
+    CFHashCode            h;
+    CFIndex               i;
+    const unsigned char * cp;
+    
+    cp = ( const unsigned char * )bytes;
     h  = 0;
     
-    while( ( c = *( cp++ ) ) )
+    for( i = 0; i < length; i++ )
     {
-        h = h * 31 + c;
+        h = h * 31 + cp[ i ];
     }
     
     return h;
@@ -103,6 +131,11 @@ bool CFStringEquals( CFStringRef s1, CFStringRef s2 )
         return false;
     }
     
+    if( s1->_hashed && s2->_hashed && s1->_hash != s2->_hash )
+    {
+        return false;
+    }
+    
     return memcmp( s1->_cStr, s2->_cStr, ( size_t )( s1->_length ) ) == 0;
 }
 
@@ -133,3 +166,203 @@ void CFStringAssertMutable( CFStringRef str )
         CFRuntimeAbortWithError( "<CFString 0x%llu> is not mutable", ( unsigned long long )str );
     }
 }
+
+bool CFStringReserveCapacity( CFMutableStringRef str, CFIndex length )
+{
+    CFIndex capacity;
+    char  * cStr;
+    
+    /* The capacity of mutable strings includes the terminating NUL */
+    if( length + 1 <= str->_capacity )
+    {
+        return true;
+    }
+    
+    /* Geometric growth, so that building a string by appends is linear */
+    capacity = str->_capacity * 2;
+    
+    if( capacity < length + 1 )
+    {
+        capacity = length + 1;
+    }
+    
+    cStr = CFAllocatorReallocate( str->_allocator, str->_cStr, capacity, 0 );
+    
+    if( cStr == NULL )
+    {
+        return false;
+    }
+    
+    str->_cStr     = cStr;
+    str->_capacity = capacity;
+    
+    return true;
+}
+
+void CFStringAppendBytes( CFMutableStringRef str, const char * bytes, CFIndex length )
+{
+    CFIndex offset;
+    
+    if( length <= 0 )
+    {
+        return;
+    }
+    
+    /* The bytes may belong to str itself, and move if it is reallocated */
+    offset = -1;
+    
+    if
+    (
+           ( uintptr_t )bytes >= ( uintptr_t )( str->_cStr )
+        && ( uintptr_t )bytes <  ( uintptr_t )( str->_cStr + str->_capacity )
+    )
+    {
+        offset = ( CFIndex )( bytes - str->_cStr );
+    }
+    
+    if( CFStringReserveCapacity( str, str->_length + length ) == false )
+    {
+        return;
+    }
+    
+    if( offset >= 0 )
+    {
+        bytes = str->_cStr + offset;
+    }
+    
+    memmove( str->_cStr + str->_length, bytes, ( size_t )length );
+    
+    str->_length                = str->_length + length;
+    str->_cStr[ str->_length ]  = 0;
+    str->_hashed                = false;
+}
+
+CFStringRef CFStringInitConstant( struct CFString * str, const char * cStr, CFIndex length )
+{
+    /* Wraps cStr without copying, typically in a string on the stack */
+    memset( str, 0, sizeof( struct CFString ) );
+    
+    str->_base.isa = ( uintptr_t )&CFStringClass;
+    str->_base.rc  = -1;
+    str->_cStr     = ( char * )( uintptr_t )cStr;
+    str->_length   = length;
+    str->_capacity = length;
+    str->_encoding = kCFStringEncodingASCII;
+    str->_hash     = CFStringHashBytes( cStr, length );
+    str->_hashed   = true;
+    
+    return str;
+}
+
+CFStringRef CFStringGetUniqued( CFStringRef str )
+{
+    struct CFStringUniquingTable * table;
+    CFStringRef                    s;
+    CFIndex                        mask;
+    CFIndex                        i;
+    
+    table = CFAtomicLoadAcquirePointer( ( void * volatile * )&CFStringUniquedStrings );
+    
+    if( table == NULL || str->_cStr == NULL )
+    {
+        return NULL;
+    }
+    
+    mask = table->capacity - 1;
+    i    = ( CFIndex )( CFDictionaryMixHash( CFStringHash( str ) ) & ( CFHashCode )mask );
+    
+    /* The load factor is kept below 1/2, so there is always an empty slot */
+    while( 1 )
+    {
+        s = CFAtomicLoadAcquirePointer( ( void * volatile * )&( table->strings[ i ] ) );
+        
+        if( s == NULL )
+        {
+            return NULL;
+        }
+        
+        if( CFStringEquals( s, str ) )
+        {
+            return s;
+        }
+        
+        i = ( i + 1 ) & mask;
+    }
+}
+
+CFStringRef CFStringAddUniqued( CFStringRef str )
+{
+    struct CFStringUniquingTable * table;
+    struct CFStringUniquingTable * grown;
+    CFStringRef                    s;
+    CFIndex                        capacity;
+    CFIndex                        i;
+    
+    CFSpinLockLock( &CFStringUniquingLock );
+    
+    s = CFStringGetUniqued( str );
+    
+    if( s != NULL )
+    {
+        CFSpinLockUnlock( &CFStringUniquingLock );
+        
+        return s;
+    }
+    
+    table = CFStringUniquedStrings;
+    
+    if( table == NULL || ( CFStringUniquedCount + 1 ) * 2 > table->capacity )
+    {
+        capacity = ( table ) ? table->capacity * 2 : CF_STRING_UNIQUING_TABLE_INITIAL_CAPACITY;
+        grown    = calloc( 1, sizeof( struct CFStringUniquingTable ) + ( size_t )capacity * sizeof( CFStringRef ) );
+        
+        if( grown == NULL )
+        {
+            CFSpinLockUnlock( &CFStringUniquingLock );
+            CFRuntimeAbortWithOutOfMemoryError();
+            
+            return NULL;
+        }
+        
+        grown->capacity = capacity;
+        
+        for( i = 0; table != NULL && i < table->capacity; i++ )
+        {
+            if( table->strings[ i ] != NULL )
+            {
+                CFStringUniquingTableInsert( grown, table->strings[ i ] );
+            }
+        }
+        
+        /* The previous table is leaked, as lock-free readers may still use it */
+        CFAtomicStoreReleasePointer( grown, ( void * volatile * )&CFStringUniquedStrings );
+        
+        table = grown;
+    }
+    
+    /* Readers may retain the string as soon as it is published */
+    CFRuntimeSetObjectAsConstant( str );
+    CFStringUniquingTableInsert( table, str );
+    
+    CFStringUniquedCount++;
+    
+    CFSpinLockUnlock( &CFStringUniquingLock );
+    
+    return str;
+}
+
+void CFStringUniquingTableInsert( struct CFStringUniquingTable * table, CFStringRef str )
+{
+    CFIndex mask;
+    CFIndex i;
+    
+    mask = table->capacity - 1;
+    i    = ( CFIndex )( CFDictionaryMixHash( CFStringHash( str ) ) & ( CFHashCode )mask );
+    
+    while( table->strings[ i ] != NULL )
+    {
+        i = ( i + 1 ) & mask;
+    }
+    
+    CFAtomicStoreReleasePointer( ( void * )( uintptr_t )str, ( void * volatile * )&( table->strings[ i ] ) );
+}
@@ -28,6 +28,7 @@
  */
 
 #include <CoreFoundation/__private/__CFUUID.h>
+#include <CoreFoundation/__private/__CFAtomic.h>
 
 CFTypeID       CFUUIDTypeID = 0;
 CFRuntimeClass CFUUIDClass  =
@@ -41,7 +42,9 @@ CFRuntimeClass CFUUIDClass  =
     ( CFStringRef ( * )( CFTypeRef ) )CFUUIDCopyDescription
 };
 
-CFSpinLock          CFUUIDsLock     = 0;
+CFSpinLockStatistics CFUUIDsLockStatistics = CF_SPIN_LOCK_STATISTICS_INIT( "CFUUID registry" );
+
+CFSpinLock          CFUUIDsLock     = CF_SPIN_LOCK_INIT( &CFUUIDsLockStatistics );
 struct CFUUIDList * CFUUIDs         = NULL;
 CFUUIDBytes         CFUUIDNullBytes = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 
@@ -59,6 +62,8 @@ void CFUUIDDestruct( CFUUIDRef u )
     
     if( CFUUIDs == NULL )
     {
+        CFSpinLockUnlock( &CFUUIDsLock );
+        
         return;
     }
     
@@ -167,11 +172,45 @@ UInt8 CFUUIDByteFromHexChar( char * s )
     return ( UInt8 )strtoul( x, NULL, 16 );
 }
 
+bool CFUUIDReuse( CFUUIDRef u, bool retain )
+{
+    volatile CFIndex * rc;
+    CFIndex            value;
+    
+    rc = &( ( ( CFRuntimeBase * )( uintptr_t )u )->rc );
+    
+    while( 1 )
+    {
+        value = CFAtomicLoadAcquire( rc );
+        
+        if( value == -1 )
+        {
+            /* Constant object */
+            return true;
+        }
+        
+        if( value == 0 )
+        {
+            /*
+             * Last reference released - The destructor is waiting for the
+             * registry lock to unlink it, so it must not be returned.
+             */
+            return false;
+        }
+        
+        if( retain == false || CFAtomicCompareAndSwap( value, value + 1, rc ) )
+        {
+            return true;
+        }
+    }
+}
+
 CFUUIDRef CFUUIDGetOrCreate( CFAllocatorRef alloc, CFUUIDBytes bytes, bool returnRetainedIfExist )
 {
     struct CFUUIDList * item;
     struct CFUUIDList * list;
     struct CFUUID     * o;
+    CFUUIDRef           existing;
     
     o = ( struct CFUUID * )CFRuntimeCreateInstance( alloc, CFUUIDTypeID );
     
@@ -207,15 +246,21 @@ CFUUIDRef CFUUIDGetOrCreate( CFAllocatorRef alloc, CFUUIDBytes bytes, bool retur
     
     while( list )
     {
-        if( CFEqual( o, list->uuid ) )
+        if( CFEqual( o, list->uuid ) && CFUUIDReuse( list->uuid, returnRetainedIfExist ) )
         {
+            /*
+             * Once unlocked, another thread may release the registered UUID,
+             * and its destructor frees the list item - Reads it, and retains
+             * it in CFUUIDReuse, while the lock is still held.
+             */
+            existing = list->uuid;
+            
+            /* The destructor of the duplicate takes the lock */
+            CFSpinLockUnlock( &CFUUIDsLock );
             CFRelease( o );
             free( item );
-            CFSpinLockUnlock( &CFUUIDsLock );
-            
-            CFShow( list->uuid );
             
-            return ( returnRetainedIfExist ) ? CFRetain( list->uuid ) : list->uuid;
+            return existing;
         }
         
         list = list->next;
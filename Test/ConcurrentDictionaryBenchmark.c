@@ -0,0 +1,345 @@
+/*******************************************************************************
+ * The MIT License (MIT)
+ * 
+ * Copyright (c) 2016 Jean-David Gadina - www-xs-labs.com
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+/*!
+ * @file        ConcurrentDictionaryBenchmark.c
+ * @copyright   (c) 2016, Jean-David Gadina - www.xs-labs.com
+ * @discussion  Mixed read/write throughput of CFConcurrentDictionary against
+ *              a CFMutableDictionary behind a single mutex, at several thread
+ *              counts. Only meaningful on a host with as many CPUs as
+ *              threads - On fewer CPUs, it shows the per-operation overhead.
+ */
+
+#if !defined( _WIN32 ) && !defined( __APPLE__ ) && !defined( _POSIX_C_SOURCE )
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "ConcurrentDictionaryBenchmark.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+#if defined( _WIN32 )
+#include <Windows.h>
+#elif defined( __APPLE__ )
+#include <pthread.h>
+#include <mach/mach_time.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#define BENCHMARK_KEYS          16384
+#define BENCHMARK_VALUES        64
+#define BENCHMARK_OPERATIONS    400000
+#define BENCHMARK_MAX_THREADS   8
+
+typedef struct
+{
+    CFStringRef                 * keys;
+    CFNumberRef                 * values;
+    CFMutableDictionaryRef        dictionary;
+    CFConcurrentDictionaryRef     concurrent;
+    bool                          useConcurrent;
+    unsigned int                  writePercent;
+    unsigned int                  seed;
+    int                           operations;
+}
+BenchmarkContext;
+
+#ifdef _WIN32
+
+static CRITICAL_SECTION BenchmarkMutex;
+
+#else
+
+static pthread_mutex_t BenchmarkMutex = PTHREAD_MUTEX_INITIALIZER;
+
+#endif
+
+static void BenchmarkLock( void )
+{
+    #ifdef _WIN32
+    EnterCriticalSection( &BenchmarkMutex );
+    #else
+    pthread_mutex_lock( &BenchmarkMutex );
+    #endif
+}
+
+static void BenchmarkUnlock( void )
+{
+    #ifdef _WIN32
+    LeaveCriticalSection( &BenchmarkMutex );
+    #else
+    pthread_mutex_unlock( &BenchmarkMutex );
+    #endif
+}
+
+static unsigned int BenchmarkRandom( unsigned int * seed )
+{
+    *( seed ) ^= *( seed ) << 13;
+    *( seed ) ^= *( seed ) >> 17;
+    *( seed ) ^= *( seed ) << 5;
+    
+    return *( seed );
+}
+
+static double BenchmarkTime( void )
+{
+    #ifdef _WIN32
+    
+    LARGE_INTEGER count;
+    LARGE_INTEGER frequency;
+    
+    QueryPerformanceCounter( &count );
+    QueryPerformanceFrequency( &frequency );
+    
+    return ( double )count.QuadPart / ( double )frequency.QuadPart;
+    
+    #elif defined( __APPLE__ )
+    
+    static mach_timebase_info_data_t info;
+    
+    if( info.denom == 0 )
+    {
+        mach_timebase_info( &info );
+    }
+    
+    return ( double )( mach_absolute_time() * info.numer / info.denom ) / 1e9;
+    
+    #else
+    
+    struct timespec t;
+    
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    
+    return ( double )t.tv_sec + ( double )t.tv_nsec / 1e9;
+    
+    #endif
+}
+
+static void BenchmarkMutexDictionary( BenchmarkContext * context )
+{
+    int          i;
+    unsigned int r;
+    const void * value;
+    
+    for( i = 0; i < context->operations; i++ )
+    {
+        r = BenchmarkRandom( &( context->seed ) );
+        
+        if( r % 100 < context->writePercent )
+        {
+            BenchmarkLock();
+            CFDictionarySetValue( context->dictionary, context->keys[ ( r >> 8 ) % BENCHMARK_KEYS ], context->values[ r % BENCHMARK_VALUES ] );
+            BenchmarkUnlock();
+        }
+        else
+        {
+            /* Retained under the lock, as CFConcurrentDictionaryCopyValue does */
+            BenchmarkLock();
+            value = CFDictionaryGetValue( context->dictionary, context->keys[ ( r >> 8 ) % BENCHMARK_KEYS ] );
+            
+            if( value )
+            {
+                CFRetain( value );
+            }
+            
+            BenchmarkUnlock();
+            
+            if( value )
+            {
+                CFRelease( value );
+            }
+        }
+    }
+}
+
+static void BenchmarkConcurrentDictionary( BenchmarkContext * context )
+{
+    int          i;
+    unsigned int r;
+    const void * value;
+    
+    for( i = 0; i < context->operations; i++ )
+    {
+        r = BenchmarkRandom( &( context->seed ) );
+        
+        if( r % 100 < context->writePercent )
+        {
+            CFConcurrentDictionarySetValue( context->concurrent, context->keys[ ( r >> 8 ) % BENCHMARK_KEYS ], context->values[ r % BENCHMARK_VALUES ] );
+        }
+        else
+        {
+            value = CFConcurrentDictionaryCopyValue( context->concurrent, context->keys[ ( r >> 8 ) % BENCHMARK_KEYS ] );
+            
+            if( value )
+            {
+                CFRelease( value );
+            }
+        }
+    }
+}
+
+#ifdef _WIN32
+
+static DWORD WINAPI BenchmarkThread( LPVOID arg )
+
+#else
+
+static void * BenchmarkThread( void * arg )
+
+#endif
+
+{
+    BenchmarkContext * context;
+    
+    context = arg;
+    
+    if( context->useConcurrent )
+    {
+        BenchmarkConcurrentDictionary( context );
+    }
+    else
+    {
+        BenchmarkMutexDictionary( context );
+    }
+    
+    return 0;
+}
+
+static double BenchmarkRun( BenchmarkContext * context, int threads )
+{
+    BenchmarkContext contexts[ BENCHMARK_MAX_THREADS ];
+    double           start;
+    int              i;
+    
+    #ifdef _WIN32
+    HANDLE           handles[ BENCHMARK_MAX_THREADS ];
+    #else
+    pthread_t        handles[ BENCHMARK_MAX_THREADS ];
+    #endif
+    
+    start = BenchmarkTime();
+    
+    for( i = 0; i < threads; i++ )
+    {
+        contexts[ i ]            = *( context );
+        contexts[ i ].seed       = ( unsigned int )( i + 1 ) * 2654435761U;
+        contexts[ i ].operations = BENCHMARK_OPERATIONS / threads;
+        
+        #ifdef _WIN32
+        handles[ i ] = CreateThread( NULL, 0, BenchmarkThread, &( contexts[ i ] ), 0, NULL );
+        #else
+        pthread_create( &( handles[ i ] ), NULL, BenchmarkThread, &( contexts[ i ] ) );
+        #endif
+    }
+    
+    for( i = 0; i < threads; i++ )
+    {
+        #ifdef _WIN32
+        WaitForSingleObject( handles[ i ], INFINITE );
+        CloseHandle( handles[ i ] );
+        #else
+        pthread_join( handles[ i ], NULL );
+        #endif
+    }
+    
+    /* Millions of operations per second */
+    return ( double )BENCHMARK_OPERATIONS / ( BenchmarkTime() - start ) / 1e6;
+}
+
+void ConcurrentDictionaryBenchmark( void )
+{
+    static const unsigned int writePercents[] = { 10, 50 };
+    static const int          threadCounts[]  = { 1, 2, 4, 8 };
+    BenchmarkContext          context;
+    CFStringRef               keys[ BENCHMARK_KEYS ];
+    CFNumberRef               values[ BENCHMARK_VALUES ];
+    double                    mutex;
+    double                    concurrent;
+    int                       i;
+    int                       j;
+    int                       k;
+    
+    #ifdef _WIN32
+    InitializeCriticalSection( &BenchmarkMutex );
+    #endif
+    
+    for( i = 0; i < BENCHMARK_KEYS; i++ )
+    {
+        keys[ i ] = CFStringCreateWithFormat( NULL, NULL, CFSTR( "key-%i" ), i );
+    }
+    
+    for( i = 0; i < BENCHMARK_VALUES; i++ )
+    {
+        values[ i ] = CFNumberCreate( NULL, kCFNumberIntType, &i );
+    }
+    
+    context.keys   = keys;
+    context.values = values;
+    
+    fprintf( stderr, "CFConcurrentDictionary: %i keys, %i operations, Mops/s\n", BENCHMARK_KEYS, BENCHMARK_OPERATIONS );
+    fprintf( stderr, "    writes  threads  mutex+dict  concurrent\n" );
+    
+    for( i = 0; i < ( int )( sizeof( writePercents ) / sizeof( writePercents[ 0 ] ) ); i++ )
+    {
+        for( j = 0; j < ( int )( sizeof( threadCounts ) / sizeof( threadCounts[ 0 ] ) ); j++ )
+        {
+            context.writePercent = writePercents[ i ];
+            context.dictionary   = CFDictionaryCreateMutable( NULL, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks );
+            context.concurrent   = CFConcurrentDictionaryCreate( NULL, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks );
+            
+            /* Both start with every key present, so reads hit */
+            for( k = 0; k < BENCHMARK_KEYS; k++ )
+            {
+                CFDictionarySetValue( context.dictionary, keys[ k ], values[ k % BENCHMARK_VALUES ] );
+                CFConcurrentDictionarySetValue( context.concurrent, keys[ k ], values[ k % BENCHMARK_VALUES ] );
+            }
+            
+            context.useConcurrent = false;
+            mutex                 = BenchmarkRun( &context, threadCounts[ j ] );
+            context.useConcurrent = true;
+            concurrent            = BenchmarkRun( &context, threadCounts[ j ] );
+            
+            fprintf( stderr, "    %3u%%    %7i  %10.2f  %10.2f\n", writePercents[ i ], threadCounts[ j ], mutex, concurrent );
+            
+            CFRelease( context.dictionary );
+            CFRelease( context.concurrent );
+        }
+    }
+    
+    for( i = 0; i < BENCHMARK_KEYS; i++ )
+    {
+        CFRelease( keys[ i ] );
+    }
+    
+    for( i = 0; i < BENCHMARK_VALUES; i++ )
+    {
+        CFRelease( values[ i ] );
+    }
+    
+    #ifdef _WIN32
+    DeleteCriticalSection( &BenchmarkMutex );
+    #endif
+}
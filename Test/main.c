@@ -31,7 +31,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 #include "Foo.h"
+#include "ConcurrentDictionaryBenchmark.h"
 
 int main( void )
 {
@@ -277,6 +279,39 @@ int main( void )
     
     fprintf( stderr,  "--------------------------------------------------------------------------------\n" );
     
+    {
+        CFDictionaryRef        d1;
+        CFMutableDictionaryRef d2;
+        CFNumberRef            keys[ 20 ];
+        int                    i;
+        
+        for( i = 0; i < 20; i++ )
+        {
+            keys[ i ] = CFNumberCreate( NULL, kCFNumberIntType, &i );
+        }
+        
+        /* More than 8 entries, so d1 is frozen, and d2 shares its storage */
+        d1 = CFDictionaryCreateFrozen( NULL, ( const void ** )keys, ( const void ** )keys, 20, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks );
+        d2 = CFDictionaryCreateMutableCopy( NULL, 0, d1 );
+        
+        /* d2 is now the last owner of the frozen storage */
+        CFRelease( d1 );
+        CFDictionarySetValue( d2, keys[ 0 ], keys[ 1 ] );
+        CFDictionaryRemoveValue( d2, keys[ 2 ] );
+        
+        fprintf( stderr, "Mutable copy of a frozen dictionary: %li entries\n", ( long )CFDictionaryGetCount( d2 ) );
+        fprintf( stderr, "Replaced value: %i\n", CFDictionaryGetValue( d2, keys[ 0 ] ) == keys[ 1 ] );
+        
+        for( i = 0; i < 20; i++ )
+        {
+            CFRelease( keys[ i ] );
+        }
+        
+        CFRelease( d2 );
+    }
+    
+    fprintf( stderr,  "--------------------------------------------------------------------------------\n" );
+    
     {
         CFStringRef        s1;
         CFStringRef        s2;
@@ -486,5 +521,53 @@ int main( void )
     
     fprintf( stderr,  "--------------------------------------------------------------------------------\n" );
     
+    {
+        CFMutableStringRef s;
+        CFStringRef        piece;
+        clock_t            start;
+        int                i;
+        
+        /* Building a 1MB string by appends shall take linear time */
+        piece = CFSTR( "0123456789abcdef" );
+        s     = CFStringCreateMutable( NULL, 0 );
+        start = clock();
+        
+        for( i = 0; i < 65536; i++ )
+        {
+            CFStringAppend( s, piece );
+        }
+        
+        fprintf( stderr, "CFStringAppend:        %li bytes in %.2f ms\n", ( long )CFStringGetLength( s ), ( double )( clock() - start ) * 1000.0 / CLOCKS_PER_SEC );
+        CFRelease( s );
+        
+        s     = CFStringCreateMutable( NULL, 0 );
+        start = clock();
+        
+        for( i = 0; i < 65536; i++ )
+        {
+            CFStringAppendCString( s, "0123456789abcdef", kCFStringEncodingASCII );
+        }
+        
+        fprintf( stderr, "CFStringAppendCString: %li bytes in %.2f ms\n", ( long )CFStringGetLength( s ), ( double )( clock() - start ) * 1000.0 / CLOCKS_PER_SEC );
+        CFRelease( s );
+        
+        s     = CFStringCreateMutable( NULL, 0 );
+        start = clock();
+        
+        for( i = 0; i < 65536; i++ )
+        {
+            CFStringAppendFormat( s, NULL, CFSTR( "%016x" ), i );
+        }
+        
+        fprintf( stderr, "CFStringAppendFormat:  %li bytes in %.2f ms\n", ( long )CFStringGetLength( s ), ( double )( clock() - start ) * 1000.0 / CLOCKS_PER_SEC );
+        CFRelease( s );
+    }
+    
+    fprintf( stderr,  "--------------------------------------------------------------------------------\n" );
+    
+    ConcurrentDictionaryBenchmark();
+    
+    fprintf( stderr,  "--------------------------------------------------------------------------------\n" );
+    
     return 0;
 }